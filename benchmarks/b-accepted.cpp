@@ -0,0 +1,48 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+
+    // Measure formatting, not writing.
+    std::ostream null(nullptr);
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.out(null);
+
+    bench("accepted_default", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(info, "accepted call #" << i);
+    });
+
+    // Same styles than t-demo.
+    log.style(clutchlog::level::info, clutchlog::fmt::fg::magenta);
+    std::ostringstream format;
+    clutchlog::fmt reset(clutchlog::fmt::typo::reset);
+    clutchlog::fmt discreet(clutchlog::fmt::fg::black);
+    clutchlog::fmt bold(clutchlog::fmt::typo::bold);
+    format << "{level_fmt}"
+           << "{level_letter}:"
+           << "{depth_marks} "
+           << bold("{msg}")
+           << discreet(" {hfill} ")
+           << "{level_fmt}{func}"
+           << discreet(" @ ")
+           << "{level_fmt}{file}"
+           << reset << ":"
+           << "{level_fmt}{line}"
+           << "\n";
+    log.format(format.str());
+    log.depth_mark(">");
+
+    bench("accepted_styled", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(info, "accepted call #" << i);
+    });
+
+    log.out(std::clog);
+}
@@ -0,0 +1,31 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+    const std::string path = argc > 2 ? argv[2] : "/dev/null";
+
+    std::ofstream file(path);
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.out(file);
+
+    // Time spent in the calling thread.
+    bench("written_sync", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(info, "written call #" << i);
+    });
+
+    log.async(true);
+    bench("written_async", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(info, "written call #" << i);
+    });
+    log.async(false);
+
+    log.out(std::clog);
+}
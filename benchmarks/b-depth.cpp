@@ -0,0 +1,22 @@
+#include <iostream>
+#include <string>
+
+// Measure the run time filtering, even in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 1000000);
+
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    // Every call is too deep, whatever the number of frames inlined by the compiler.
+    log.strip_calls(0);
+    log.depth(0);
+
+    bench("rejected_depth", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(debug, "rejected call #" << i);
+    });
+}
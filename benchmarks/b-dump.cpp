@@ -0,0 +1,40 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <numeric>
+#include <cstdio>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 10);
+
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+
+    std::vector<double> data(1000000);
+    std::iota(data.begin(), data.end(), 0.5);
+
+    const std::string filename = "clutchlog_b-dump.dat";
+    bench("dump_1M", n, [&](const size_t){
+        CLUTCHDUMP(info, data, filename);
+    });
+
+    log.dump_mode(clutchlog::binary);
+    bench("dump_1M_binary", n, [&](const size_t){
+        CLUTCHDUMP(info, data, filename);
+    });
+    std::remove(filename.c_str());
+
+    // Numbered files: the n-th dump should not probe the n previous ones.
+    const fs::path dir = "clutchlog_b-dump_numbered";
+    fs::create_directory(dir);
+    const std::vector<double> small(10, 0.5);
+    bench("dump_numbered", 100 * n, [&](const size_t){
+        CLUTCHDUMP(info, small, (dir / "dump_{n}.dat").string());
+    });
+    fs::remove_all(dir);
+}
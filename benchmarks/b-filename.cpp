@@ -0,0 +1,30 @@
+#include <iostream>
+#include <string>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+
+    // Measure the file name rendering, not writing.
+    std::ostream null(nullptr);
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.out(null);
+    log.format("{file}:{line} {msg}\n");
+
+    log.filename(clutchlog::filename::path);
+    bench("filename_path", n, [&](const size_t){
+        CLUTCHLOG(info, "accepted");
+    });
+
+    log.filename(clutchlog::filename::dirstem);
+    bench("filename_dirstem", n, [&](const size_t){
+        CLUTCHLOG(info, "accepted");
+    });
+
+    log.out(std::clog);
+}
@@ -0,0 +1,52 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+//! Measure messages written to a file under the current flush policy (including a final flush).
+void measure(const std::string& name, const size_t n)
+{
+    auto& log = clutchlog::logger();
+    bench(name, n, [&](const size_t i){
+        CLUTCHLOG(info, "written call #" << i);
+        if(i == n-1) { log.flush(); }
+    });
+}
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+    const std::string path = argc > 2 ? argv[2] : "clutchlog_b-flush.log";
+
+    std::ofstream file(path);
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format("{level_letter} {msg}\n"); // Focus on writing.
+    log.out(file);
+
+    log.flush_policy(clutchlog::flushing::always);
+    measure("flush_always", n);
+
+    log.flush_policy(clutchlog::flushing::on_level);
+    log.flush_level(clutchlog::level::error);
+    measure("flush_on_level", n);
+
+    log.flush_policy(clutchlog::flushing::every_n);
+    log.flush_n(100);
+    measure("flush_every_n", n);
+
+    log.flush_policy(clutchlog::flushing::every_ms);
+    log.flush_ms(100);
+    measure("flush_every_ms", n);
+
+    log.flush_policy(clutchlog::flushing::manual);
+    measure("flush_manual", n);
+
+    log.out(std::clog);
+    file.close();
+    std::remove(path.c_str());
+}
@@ -0,0 +1,31 @@
+#include <iostream>
+#include <string>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+static constexpr char styled[] = "{level_fmt}{level_letter}:{level_short} {msg} {funchash_fmt}{func} @ {filehash_fmt}{file}:{line}\n";
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 1000000);
+
+    // Measure formatting, not writing.
+    std::ostream null(nullptr);
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.out(null);
+
+    log.format(styled);
+    bench("format_runtime", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(info, "accepted call #" << i);
+    });
+
+    log.format<styled>();
+    bench("format_compiled", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(info, "accepted call #" << i);
+    });
+
+    log.out(std::clog);
+}
@@ -0,0 +1,39 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 1000000);
+
+    const std::vector<clutchlog::fmt> styles = {
+        clutchlog::fmt(clutchlog::fmt::fg::red),
+        clutchlog::fmt(clutchlog::fmt::fg::green),
+        clutchlog::fmt(clutchlog::fmt::fg::blue)
+    };
+    const std::string words[] = {"main", "operator()", "clutchlog::fmt::hash"};
+
+    size_t total = 0; // Keep the results alive.
+    bench("fmt_hash", n, [&](const size_t i){
+        total += clutchlog::fmt::hash(words[i % 3], styles).str().size();
+    });
+    std::clog << total << std::endl;
+
+    // Value-dependant styles within accepted messages.
+    std::ostream null(nullptr);
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.out(null);
+    log.format("{filehash_fmt}{file} {funchash_fmt}{func} {msg}\n");
+    log.funchash_styles(styles);
+
+    bench("accepted_hash", n / 10, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(info, "accepted call #" << i);
+    });
+
+    log.out(std::clog);
+}
@@ -0,0 +1,20 @@
+#include <iostream>
+#include <string>
+
+// Measure the run time filtering, even in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 1000000);
+
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.location("nowhere", "(nothing|nope)", "[0-9]+");
+
+    bench("rejected_location", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(debug, "rejected call #" << i);
+    });
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+//! Measure messages written to a file under the current flush policy (including a final flush).
+void measure(const std::string& name, const size_t n)
+{
+    auto& log = clutchlog::logger();
+    bench(name, n, [&](const size_t i){
+        CLUTCHLOG(info, "written call #" << i);
+        if(i == n-1) { log.flush(); }
+    });
+}
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+    const std::string path = argc > 2 ? argv[2] : "clutchlog_b-out-fd.log";
+
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format("{level_letter} {msg}\n"); // Focus on writing.
+
+    // Through the iostreams.
+    std::ofstream file(path);
+    log.out(file);
+    log.flush_policy(clutchlog::flushing::always);
+    measure("out_stream_always", n);
+    log.flush_policy(clutchlog::flushing::every_n);
+    log.flush_n(100);
+    measure("out_stream_every_n", n);
+    log.out(std::clog);
+    file.close();
+
+    // Directly on the file descriptor.
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    log.out_fd(fd);
+    log.flush_policy(clutchlog::flushing::always);
+    measure("out_fd_always", n);
+    log.flush_policy(clutchlog::flushing::every_n);
+    log.flush_n(100);
+    measure("out_fd_every_n", n);
+    log.async(true);
+    measure("out_fd_async", n);
+    log.async(false);
+    log.out(std::clog);
+    close(fd);
+
+    std::remove(path.c_str());
+}
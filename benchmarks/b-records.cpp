@@ -0,0 +1,46 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.flush_policy(clutchlog::flushing::manual); // Focus on encoding.
+    log.format("{level_letter} {msg}\t{func} @ {file}:{line}\n"); // No stack depth.
+    const std::string word = "word";
+
+    std::ostringstream out;
+    log.out(out);
+    bench("records_formatted", n, [&](const size_t i){
+        CLUTCHLOG(info, "call #" << i << " of " << word << " at " << 0.5 * i);
+        if(i % 1000 == 0) { out.str(""); }
+    });
+
+    log.out_mode(clutchlog::encoding::records);
+    bench("records_binary", n, [&](const size_t i){
+        CLUTCHLOG(info, "call #" << i << " of " << word << " at " << 0.5 * i);
+        if(i % 1000 == 0) { out.str(""); }
+    });
+
+    // Offline cost.
+    out.str("");
+    log.out(out); // Starts the records again.
+    for(size_t i = 0; i < n; ++i) {
+        CLUTCHLOG(info, "call #" << i << " of " << word << " at " << 0.5 * i);
+    }
+    const std::string records = out.str();
+    std::ostringstream decoded;
+    bench("records_decode", 1, [&](const size_t){
+        log.decode(records, decoded);
+    });
+
+    log.out_mode(clutchlog::encoding::formatted);
+    log.out(std::clog);
+}
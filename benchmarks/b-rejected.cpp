@@ -0,0 +1,29 @@
+#include <iostream>
+#include <string>
+
+// Measure the run time filtering, even in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+struct costly {
+    double value;
+    friend std::ostream& operator<<(std::ostream& os, const costly& c)
+    {
+        return os << "costly(" << c.value << ")";
+    }
+};
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 1000000);
+
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::error);
+
+    const std::string word = "rejected";
+
+    bench("rejected_level", n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(debug, word << " call #" << i << " with " << costly{3.14159} << " and " << 1.0/(i+1));
+    });
+}
@@ -0,0 +1,42 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+//! Measure messages written to the given stream, the writer should not wait for the compressions.
+void measure(const std::string& name, std::ostream& out, const size_t n)
+{
+    auto& log = clutchlog::logger();
+    log.out(out);
+    bench(name, n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(info, "written call #" << i << " with some padding to fill the files faster");
+    });
+    log.out(std::clog);
+}
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 200000);
+
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format("{level_letter} {msg}\n"); // Focus on writing.
+    log.flush_policy(clutchlog::flushing::every_n);
+    log.flush_n(100);
+
+    const fs::path dir = "clutchlog_b-rotating";
+    fs::create_directory(dir);
+    {
+        std::ofstream file(dir / "plain.log");
+        measure("rotating_none", file, n);
+    }
+    {
+        // Rotate every MB.
+        clutchlog::rotating_file file((dir / "rotated.log").string(), 1024*1024, std::chrono::seconds(0), 3);
+        measure("rotating_1MB", file, n);
+    }
+    fs::remove_all(dir);
+}
@@ -0,0 +1,41 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+
+    auto& log = clutchlog::logger();
+    log.flush_policy(clutchlog::flushing::manual); // Focus on formatting.
+
+    // A styled terminal at progress, a plain file at xdebug.
+    std::ostringstream term;
+    std::ostringstream file;
+    log.out(term);
+    log.threshold(clutchlog::level::progress);
+    bench("sinks_out_only", n, [&](const size_t i){
+        CLUTCHLOG(progress, "both call #" << i);
+        if(i % 1000 == 0) { term.str(""); }
+    });
+
+    const size_t id = log.add_sink(file, clutchlog::level::xdebug, "{level_short} {file}:{line} {msg}\n", false);
+    bench("sinks_both", n, [&](const size_t i){
+        CLUTCHLOG(progress, "both call #" << i);
+        if(i % 1000 == 0) { term.str(""); file.str(""); }
+    });
+    bench("sinks_file_only", n, [&](const size_t i){
+        CLUTCHLOG(xdebug, "file call #" << i);
+        if(i % 1000 == 0) { file.str(""); }
+    });
+    log.sink_threshold(id, clutchlog::level::progress);
+    bench("sinks_rejected", 10 * n, [&]([[maybe_unused]] const size_t i){
+        CLUTCHLOG(xdebug, "rejected call #" << i);
+    });
+
+    log.out(std::clog);
+}
@@ -0,0 +1,37 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.flush_policy(clutchlog::flushing::manual); // Focus on encoding.
+
+    std::ostringstream out;
+    log.out(out);
+    // The default template, styled and filled.
+    bench("structured_styled", n, [&](const size_t i){
+        CLUTCHLOG(info, "call \"#" << i << "\"");
+        if(i % 1000 == 0) { out.str(""); }
+    });
+    log.out_mode(clutchlog::encoding::json);
+    bench("structured_json", n, [&](const size_t i){
+        CLUTCHLOG(info, "call \"#" << i << "\"");
+        if(i % 1000 == 0) { out.str(""); }
+    });
+    log.out_mode(clutchlog::encoding::logfmt);
+    bench("structured_logfmt", n, [&](const size_t i){
+        CLUTCHLOG(info, "call \"#" << i << "\"");
+        if(i % 1000 == 0) { out.str(""); }
+    });
+
+    log.out_mode(clutchlog::encoding::formatted);
+    log.out(std::clog);
+}
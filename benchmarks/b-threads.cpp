@@ -0,0 +1,43 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "bench.h"
+
+//! Mean time per call, when `nb_threads` threads log `n` messages each.
+void measure(const size_t nb_threads, const size_t n)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for(size_t t = 0; t < nb_threads; ++t) {
+        workers.emplace_back([n](){
+            for(size_t i = 0; i < n; ++i) {
+                CLUTCHLOG(info, "accepted call #" << i);
+            }
+        });
+    }
+    for(auto& w : workers) { w.join(); }
+    const auto stop = std::chrono::steady_clock::now();
+    bench_report("accepted_threads_" + std::to_string(nb_threads), nb_threads * n,
+        std::chrono::duration<double, std::nano>(stop - start).count());
+}
+
+int main(const int argc, char* argv[])
+{
+    const size_t n = bench_calls(argc, argv, 100000);
+
+    std::ostream null(nullptr);
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format("{level_letter} {msg} {func} @ {file}:{line}\n");
+    log.out(null);
+
+    measure(1, n);
+    measure(std::max(2u, std::thread::hardware_concurrency()), n);
+
+    log.out(std::clog);
+}
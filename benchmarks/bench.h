@@ -0,0 +1,62 @@
+#ifndef CLUTCHLOG_BENCH_H
+#define CLUTCHLOG_BENCH_H
+
+/** @file bench.h
+ * Helpers shared by the micro-benchmarks.
+ *
+ * Each result is printed as one JSON object per line,
+ * on the standard output, and appended to the file named by
+ * the `CLUTCHLOG_BENCH_OUTPUT` environment variable, if set.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+
+#ifndef CLUTCHLOG_BENCH_VERSION
+    //! Version of clutchlog being measured.
+    #define CLUTCHLOG_BENCH_VERSION "unknown"
+#endif
+
+//! Number of calls to measure: the first command line argument, if any.
+inline size_t bench_calls(const int argc, char* argv[], const size_t default_calls)
+{
+    return argc > 1 ? std::stoul(argv[1]) : default_calls;
+}
+
+//! Print the mean time of `calls` calls to the benchmark `name`, given the total time in nanoseconds.
+inline void bench_report(const std::string& name, const size_t calls, const double total_ns)
+{
+    std::ostringstream line;
+    line << "{\"bench\": \"" << name << "\""
+         << ", \"version\": \"" << CLUTCHLOG_BENCH_VERSION << "\""
+         << ", \"calls\": " << calls
+         << ", \"ns_per_call\": " << total_ns / calls
+         << "}";
+    std::cout << line.str() << std::endl;
+
+    const char* output = std::getenv("CLUTCHLOG_BENCH_OUTPUT");
+    if(output) {
+        std::ofstream file(output, std::ios::app);
+        file << line.str() << std::endl;
+    }
+}
+
+//! Measure `calls` calls to `call(i)` and report the mean time per call.
+template<class F>
+double bench(const std::string& name, const size_t calls, F call)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < calls; ++i) {
+        call(i);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    bench_report(name, calls, ns);
+    return ns / calls;
+}
+
+#endif // CLUTCHLOG_BENCH_H
@@ -14,21 +14,41 @@
 #endif
 
 #include <iterator>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <cassert>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <iomanip>
 #include <string>
 #include <limits>
+#include <type_traits>
 #include <regex>
+#include <vector>
+#include <array>
+#include <string_view>
+#include <optional>
+#include <charconv>
+#include <utility>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 //! True if POSIX headers necessary for stack depth management are available.
 #if __has_include(<execinfo.h>) && __has_include(<stdlib.h>) && __has_include(<libgen.h>)
     #include <execinfo.h> // execinfo
     #include <stdlib.h>   // getenv
     #include <libgen.h>   // basename
+    #include <errno.h>    // program_invocation_short_name
     #define CLUTCHLOG_HAVE_UNIX_SYSINFO 1
 #else
     #define CLUTCHLOG_HAVE_UNIX_SYSINFO 0
@@ -36,16 +56,26 @@
 #endif
 
 //! True if the system can handle the `hfill` feature.
-#if __has_include(<sys/ioctl.h>) && __has_include(<stdio.h>) && __has_include(<unistd.h>)
+#if __has_include(<sys/ioctl.h>) && __has_include(<stdio.h>) && __has_include(<unistd.h>) && __has_include(<sys/uio.h>)
     #include <sys/ioctl.h>
+    #include <sys/uio.h>
     #include <stdio.h>
     #include <unistd.h>
+    #include <signal.h>
     #define CLUTCHLOG_HAVE_UNIX_SYSIOCTL 1
 #else
     #define CLUTCHLOG_HAVE_UNIX_SYSIOCTL 0
     // #pragma message("[clutchlog] no POSIX SYSIOCTL header")
 #endif
 
+//! If set to 1, rotated log files are compressed with zlib (the program should then be linked with `-lz`).
+#ifndef CLUTCHLOG_WITH_ZLIB
+    #define CLUTCHLOG_WITH_ZLIB 0
+#endif
+#if CLUTCHLOG_WITH_ZLIB == 1
+    #include <zlib.h>
+#endif
+
 
 /**********************************************************************
  * Enable by default in Debug builds.
@@ -75,6 +105,20 @@
     #define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::progress
 #endif // CLUTCHLOG_DEFAULT_DEPTH_BUILT
 
+#ifndef CLUTCHLOG_MIN_LEVEL
+    #ifndef NDEBUG
+        //! Least important level for which calls to the logger are compiled (the other ones generate no code at all).
+        #define CLUTCHLOG_MIN_LEVEL clutchlog::level::xdebug
+    #else
+        #define CLUTCHLOG_MIN_LEVEL CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG
+    #endif
+#endif // CLUTCHLOG_MIN_LEVEL
+
+#ifndef CLUTCHLOG_DEPTH_SCOPE
+    //! If set to 1, the stack depth is the number of enclosing `CLUTCHSCOPE`, instead of being measured with `backtrace`.
+    #define CLUTCHLOG_DEPTH_SCOPE 0
+#endif // CLUTCHLOG_DEPTH_SCOPE
+
 /** @} DefaultConfig */
 
 
@@ -84,90 +128,81 @@
 //! Handy shortcuts to location.
 #define CLUTCHLOC __FILE__, __FUNCTION__, __LINE__
 
-//! Log a message at the given level and with a given depth delta.
-#ifndef NDEBUG
-    #define CLUTCHLOGD( LEVEL, WHAT, DEPTH_DELTA ) do {                                                   \
+//! Count the current scope as one level of stack depth (only if CLUTCHLOG_DEPTH_SCOPE is set to 1).
+#if CLUTCHLOG_DEPTH_SCOPE == 1
+    #define CLUTCHSCOPE() \
+        clutchlog::depth_t clutchlog__depth
+#else
+    #define CLUTCHSCOPE() do {/*nothing*/} while(0)
+#endif
+
+//! Handy shortcut to declare the static data of the current call site.
+#define CLUTCHSITE( LEVEL ) \
+    static clutchlog::site_t clutchlog__site(clutchlog::level::LEVEL, CLUTCHLOC)
+
+//! Log a message at the given level and with a given depth delta (the message is only built if the location matches).
+#define CLUTCHLOGD( LEVEL, WHAT, DEPTH_DELTA ) do {                                                       \
+    if constexpr(clutchlog::level::LEVEL <= CLUTCHLOG_MIN_LEVEL) {                                        \
         auto& clutchlog__logger = clutchlog::logger();                                                    \
-        std::ostringstream clutchlog__msg ; clutchlog__msg << WHAT;                                       \
-        clutchlog__logger.log(clutchlog::level::LEVEL, clutchlog__msg.str(), CLUTCHLOC, DEPTH_DELTA);     \
-    } while(0)
-#else // not Debug build.
-    #define CLUTCHLOGD( LEVEL, WHAT, DEPTH_DELTA ) do {                                                   \
-        if(clutchlog::level::LEVEL <= CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG) {                            \
-            auto& clutchlog__logger = clutchlog::logger();                                                \
-            std::ostringstream clutchlog__msg ; clutchlog__msg << WHAT;                                   \
-            clutchlog__logger.log(clutchlog::level::LEVEL, clutchlog__msg.str(), CLUTCHLOC, DEPTH_DELTA); \
+        CLUTCHSITE(LEVEL);                                                                                \
+        if(clutchlog__site.passes(clutchlog__logger)) {                                                   \
+            /* One call less than through log(), for the depth. */                                        \
+            clutchlog::scope_t clutchlog__scope                                                           \
+                = clutchlog__logger.locate(clutchlog__site, clutchlog__logger.log_depth(), 1);            \
+            if(clutchlog__scope.matches) {                                                                \
+                if(clutchlog__logger.recording()) {                                                       \
+                    clutchlog::recording_t clutchlog__rec;                                                \
+                    clutchlog__rec.recorder() << WHAT;                                                    \
+                    clutchlog__logger.log(clutchlog__scope, clutchlog__site,                              \
+                        clutchlog__rec, DEPTH_DELTA);                                                     \
+                } else {                                                                                  \
+                    std::ostringstream clutchlog__msg;                                                    \
+                    clutchlog__msg << WHAT;                                                               \
+                    clutchlog__logger.log(clutchlog__scope, clutchlog__site,                              \
+                        clutchlog__msg.str(), DEPTH_DELTA);                                               \
+                }                                                                                         \
+            }                                                                                             \
         }                                                                                                 \
-    } while(0)
-#endif // NDEBUG
+    }                                                                                                     \
+} while(0)
 
 //! Log a message at the given level.
-#ifndef NDEBUG
-    #define CLUTCHLOG( LEVEL, WHAT ) \
-        CLUTCHLOGD(LEVEL, WHAT, 0)
-#else // not Debug build.
-    #define CLUTCHLOG( LEVEL, WHAT ) \
-        CLUTCHLOGD(LEVEL, WHAT, 0)
-#endif // NDEBUG
+#define CLUTCHLOG( LEVEL, WHAT ) \
+    CLUTCHLOGD(LEVEL, WHAT, 0)
 
 //! Dump the given container.
-#ifndef NDEBUG
-    #define CLUTCHDUMP( LEVEL, CONTAINER, FILENAME ) do {                                           \
-        auto& clutchlog__logger = clutchlog::logger();                                              \
-        clutchlog__logger.dump(clutchlog::level::LEVEL, std::begin(CONTAINER), std::end(CONTAINER), \
-                    CLUTCHLOC, FILENAME, CLUTCHDUMP_DEFAULT_SEP);                                   \
-    } while(0)
-#else // not Debug build.
-    #define CLUTCHDUMP( LEVEL, CONTAINER, FILENAME ) do {                                               \
-        if(clutchlog::level::LEVEL <= CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG) {                          \
-            auto& clutchlog__logger = clutchlog::logger();                                              \
-            clutchlog__logger.dump(clutchlog::level::LEVEL, std::begin(CONTAINER), std::end(CONTAINER), \
-                        CLUTCHLOC, FILENAME, CLUTCHDUMP_DEFAULT_SEP);                                   \
-        }                                                                                               \
-    } while(0)
-#endif // NDEBUG
+#define CLUTCHDUMP( LEVEL, CONTAINER, FILENAME ) do {                                                   \
+    if constexpr(clutchlog::level::LEVEL <= CLUTCHLOG_MIN_LEVEL) {                                      \
+        auto& clutchlog__logger = clutchlog::logger();                                                  \
+        CLUTCHSITE(LEVEL);                                                                              \
+        clutchlog__logger.dump(clutchlog__site, std::begin(CONTAINER), std::end(CONTAINER),             \
+                    FILENAME, CLUTCHDUMP_DEFAULT_SEP);                                                  \
+    }                                                                                                   \
+} while(0)
 
 //! Call any function if the scope matches.
-#ifndef NDEBUG
-    #define CLUTCHFUNC( LEVEL, FUNC, ... ) do {                                                             \
+#define CLUTCHFUNC( LEVEL, FUNC, ... ) do {                                                                 \
+    if constexpr(clutchlog::level::LEVEL <= CLUTCHLOG_MIN_LEVEL) {                                          \
         auto& clutchlog__logger = clutchlog::logger();                                                      \
-        clutchlog::scope_t clutchlog__scope = clutchlog__logger.locate(clutchlog::level::LEVEL, CLUTCHLOC); \
+        CLUTCHSITE(LEVEL);                                                                                  \
+        clutchlog::scope_t clutchlog__scope = clutchlog__logger.locate(clutchlog__site, false);             \
         if(clutchlog__scope.matches) {                                                                      \
             FUNC(__VA_ARGS__);                                                                              \
         }                                                                                                   \
-    } while(0)
-#else // not Debug build.
-    #define CLUTCHFUNC( LEVEL, FUNC, ... ) do {                                                                 \
-        if(clutchlog::level::LEVEL <= CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG) {                                  \
-            auto& clutchlog__logger = clutchlog::logger();                                                      \
-            clutchlog::scope_t clutchlog__scope = clutchlog__logger.locate(clutchlog::level::LEVEL, CLUTCHLOC); \
-            if(clutchlog__scope.matches) {                                                                      \
-                FUNC(__VA_ARGS__);                                                                              \
-            }                                                                                                   \
-        }                                                                                                       \
-    } while(0)
-#endif // NDEBUG
+    }                                                                                                       \
+} while(0)
 
 //! Run any code if the scope matches.
-#ifndef NDEBUG
-    #define CLUTCHCODE( LEVEL, ... ) do {                                                                   \
+#define CLUTCHCODE( LEVEL, ... ) do {                                                                       \
+    if constexpr(clutchlog::level::LEVEL <= CLUTCHLOG_MIN_LEVEL) {                                          \
         auto& clutchlog__logger = clutchlog::logger();                                                      \
-        clutchlog::scope_t clutchlog__scope = clutchlog__logger.locate(clutchlog::level::LEVEL, CLUTCHLOC); \
+        CLUTCHSITE(LEVEL);                                                                                  \
+        clutchlog::scope_t clutchlog__scope = clutchlog__logger.locate(clutchlog__site, false);             \
         if(clutchlog__scope.matches) {                                                                      \
             __VA_ARGS__                                                                                     \
         }                                                                                                   \
-    } while(0)
-#else // not Debug build.
-    #define CLUTCHCODE( LEVEL, CODE ) do {                                                                      \
-        if(clutchlog::level::LEVEL <= CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG) {                                  \
-            auto& clutchlog__logger = clutchlog::logger();                                                      \
-            clutchlog::scope_t clutchlog__scope = clutchlog__logger.locate(clutchlog::level::LEVEL, CLUTCHLOC); \
-            if(clutchlog__scope.matches) {                                                                      \
-                CODE                                                                                            \
-            }                                                                                                   \
-        }                                                                                                       \
-    } while(0)
-#endif // NDEBUG
+    }                                                                                                       \
+} while(0)
 
 /** @} UseMacros */
 
@@ -177,7 +212,8 @@
     #define CLUTCHLOGD( LEVEL, WHAT, DEPTH_DELTA )   do {/*nothing*/} while(0)
     #define CLUTCHDUMP( LEVEL, CONTAINER, FILENAME ) do {/*nothing*/} while(0)
     #define CLUTCHFUNC( LEVEL, FUNC, ... )           do {/*nothing*/} while(0)
-    #define CLUTCHCODE( LEVEL, CODE )                do {/*nothing*/} while(0)
+    #define CLUTCHCODE( LEVEL, ... )                 do {/*nothing*/} while(0)
+    #define CLUTCHSCOPE()                            do {/*nothing*/} while(0)
     // #pragma message("[clutchlog] fully disabled")
 #endif // WITH_CLUTCHLOG
 
@@ -253,6 +289,21 @@ class clutchlog
         //! Default format of the comment line in file dump.
         static inline std::string dump_default_format = CLUTCHDUMP_DEFAULT_FORMAT;
 
+        #ifndef CLUTCHLOG_STATIC_FORMATS
+            /** If set to 1, the default formats are parsed at compile time.
+             *
+             * In that case, `CLUTCHLOG_DEFAULT_FORMAT` and `CLUTCHDUMP_DEFAULT_FORMAT`
+             * should be string literals.
+             */
+            #define CLUTCHLOG_STATIC_FORMATS 0
+        #endif
+        #if CLUTCHLOG_STATIC_FORMATS == 1
+            //! Default format of the messages, as a compile-time string.
+            static constexpr char default_format_static[] = CLUTCHLOG_DEFAULT_FORMAT;
+            //! Default format of the comment line in file dump, as a compile-time string.
+            static constexpr char dump_default_format_static[] = CLUTCHDUMP_DEFAULT_FORMAT;
+        #endif
+
         #ifndef CLUTCHDUMP_DEFAULT_SEP
             //! Compile-time default item separator for dump.
             #define CLUTCHDUMP_DEFAULT_SEP "\n"
@@ -297,6 +348,13 @@ class clutchlog
 
         // NOTE: there is no CLUTCHLOG_HFILL_STYLE for defaulting,
         // but you can still set `hfill_style(...)` on the logger singleton.
+
+        #ifndef CLUTCHLOG_DEFAULT_ASYNC_CAPACITY
+            //! Compile-time default maximum number of messages waiting to be written in asynchronous mode.
+            #define CLUTCHLOG_DEFAULT_ASYNC_CAPACITY 4096
+        #endif // CLUTCHLOG_DEFAULT_ASYNC_CAPACITY
+        //! Default maximum number of messages waiting to be written in asynchronous mode.
+        static inline size_t default_async_capacity = CLUTCHLOG_DEFAULT_ASYNC_CAPACITY;
     /* @} DefaultConfig */
     /* @} */
 
@@ -321,9 +379,27 @@ class clutchlog
         //! Available log levels.
         enum level {critical=0, error=1, warning=2, progress=3, note=4, info=5, debug=6, xdebug=7};
 
+        //! Number of log levels (which are numbered from zero).
+        static constexpr size_t nb_levels = level::xdebug + 1;
+
         //! Available filename rendering methods.
         enum filename {path, base, dir, dirbase, stem, dirstem};
 
+        //! Available behaviors when the asynchronous queue is full.
+        enum overflow {block, drop_newest, drop_oldest};
+
+        //! Available policies for flushing the output stream.
+        enum flushing {always, on_level, every_n, every_ms, manual};
+
+        //! Available states of a call site: following the filters, or forced on or off.
+        enum switching {follow, enabled, disabled};
+
+        //! Available encodings of the dumped containers.
+        enum dumping {text, binary};
+
+        //! Available encodings of the messages written on the output stream.
+        enum encoding {formatted, records, json, logfmt};
+
         /** @} */
 
         /** @addtogroup Formating Formating tools
@@ -384,6 +460,9 @@ class clutchlog
          *       you have to bass a `fg::none` tag as first argument.
          *
          * @note All styles may not be supported by a given terminal/operating system.
+         *
+         * @note The escape sequence is rendered at construction,
+         *       and again each time it is changed with a setter.
          */
         class fmt {
             public:
@@ -395,7 +474,7 @@ class clutchlog
                     colors_256 = 5,  // Casted as short in color::operator<<.
                     //! 16 millions ("true") colors mode.
                     colors_16M = 2   // Casted as short in color::operator<<
-                } /** Current ANSI color mode. */ mode;
+                };
 
                 //! Typographic style codes.
                 enum class typo {
@@ -404,7 +483,7 @@ class clutchlog
                     underline =  4,
                     inverse   =  7,
                     none = -1
-                } /** Typographic style. */  style;
+                };
 
                 /** @addtogroup colors16 Colors management in 16 colors mode (4-bits ANSI).
                  * @{ */
@@ -427,7 +506,7 @@ class clutchlog
                     bright_cyan    = 96,
                     bright_white   = 97,
                     none = -1
-                } /** Foreground color. */ fore;
+                };
 
                 //! Background color codes.
                 enum class bg {
@@ -448,39 +527,59 @@ class clutchlog
                     bright_cyan    = 106,
                     bright_white   = 107,
                     none = -1
-                } /** Background color. */ back;
+                };
 
             protected:
-                //! Output stream operator for a 3-tuple of 16-colors mode tags.
-                friend std::ostream& operator<<(std::ostream& os, const std::tuple<fg,bg,typo>& fbs)
-                {
-                    auto [f,b,s] = fbs;
-                        std::vector<short> codes; codes.reserve(3);
-                        if(f !=   fg::none) { codes.push_back(static_cast<short>(f));}
-                        if(b !=   bg::none) { codes.push_back(static_cast<short>(b));}
-                        if(s != typo::none) { codes.push_back(static_cast<short>(s));}
-                        if(codes.size() == 0) {
-                            return os;
+                /** Current ANSI color mode. */
+                ansi _mode;
+                /** Typographic style. */
+                typo _style;
+                /** Foreground color (in 16-colors mode). */
+                fg _fore;
+                /** Background color (in 16-colors mode). */
+                bg _back;
 
-                        } else {
-                            os << "\033[";
-                            os << codes[0];
-                            for(size_t i=1; i < codes.size(); ++i) {
-                                os << ";" << codes[i];
+            public:
+                //! Maximum size of an escape sequence (two 16M colors and a style).
+                static constexpr size_t escape_capacity = 48;
+
+            protected:
+                //! An escape sequence, rendered once in a fixed buffer.
+                struct escape_t {
+                    char data[escape_capacity];
+                    unsigned char size = 0;
+
+                    //! Append a single character.
+                    void append(const char c)
+                    {
+                        assert(size < escape_capacity);
+                        data[size++] = c;
+                    }
+
+                    //! Append an ANSI code (within [0,999]) in decimal.
+                    void append(const short code)
+                    {
+                        assert(0 <= code and code <= 999);
+                        if(code >= 100) { append(static_cast<char>('0' + code / 100)); }
+                        if(code >=  10) { append(static_cast<char>('0' + code / 10 % 10)); }
+                        append(static_cast<char>('0' + code % 10));
+                    }
+
+                    //! Append a sequence of ANSI codes as a single escape, if any is set.
+                    void append_codes(std::initializer_list<short> codes)
+                    {
+                        char sep = '[';
+                        for(const short code : codes) {
+                            if(code >= 0) {
+                                if(sep == '[') { append('\033'); }
+                                append(sep);
+                                append(code);
+                                sep = ';';
                             }
-                            os << "m";
                         }
-                        return os;
-                }
-
-                //! Output stream operator for a typo tag alone, in 16-colors mode.
-                friend std::ostream& operator<<(std::ostream& os, const typo& s)
-                {
-                    if(s != typo::none) {
-                        os << "\033[" << static_cast<short>(s) << "m";
+                        if(sep != '[') { append('m'); }
                     }
-                    return os;
-                }
+                } /** Rendered escape sequence. */ _escape;
 
                 /** @} colors16 */
 
@@ -505,21 +604,19 @@ class clutchlog
                      */
                     color(ansi a, ground g) : mode(a), type(g) {}
 
-                    //! Should return true if the underying representation encodes an existing color.
-                    virtual bool is_set() const = 0;
-
-                    //! Should print the underlying representation on the given stream.
-                    virtual std::ostream& print_on( std::ostream& os) const = 0;
-
-                    //! Print the actually encoded escaped color sequence on the given stream.
-                    friend std::ostream& operator<<(std::ostream& os, const color& c)
+                    //! Append the escape sequence of the given color components.
+                    void render(escape_t& escape, std::initializer_list<short> components) const
                     {
-                        if(c.is_set()) {
-                            os << "\033[" << static_cast<short>(c.type) << ";" << static_cast<short>(c.mode) << ";";
-                            c.print_on(os);
-                            os << "m";
+                        escape.append('\033');
+                        escape.append('[');
+                        escape.append(static_cast<short>(type));
+                        escape.append(';');
+                        escape.append(static_cast<short>(mode));
+                        for(const short component : components) {
+                            escape.append(';');
+                            escape.append(component);
                         }
-                        return os;
+                        escape.append('m');
                     }
                 };
 
@@ -549,11 +646,12 @@ class clutchlog
                     //! Returns true if the underying representation encodes an existing color.
                     bool is_set() const {return index > -1;}
 
-                    //! Print the color index on the given stream.
-                    std::ostream& print_on( std::ostream& os) const
+                    //! Append the escape sequence of the color (if any) to the given one.
+                    void render(escape_t& escape) const
                     {
-                        os << index;
-                        return os;
+                        if(is_set()) {
+                            color::render(escape, {index});
+                        }
                     }
                 };
 
@@ -644,11 +742,12 @@ class clutchlog
                     //! Returns true if the underying representation encodes an existing color.
                     bool is_set() const {return red > -1 and green > -1 and blue > -1;}
 
-                    //! Print the color RGB triplet on the given stream.
-                    std::ostream& print_on( std::ostream& os) const
+                    //! Append the escape sequence of the color (if any) to the given one.
+                    void render(escape_t& escape) const
                     {
-                        os << red << ";" << green << ";" << blue;
-                        return os;
+                        if(is_set()) {
+                            color::render(escape, {red, green, blue});
+                        }
                     }
                 };
 
@@ -716,24 +815,24 @@ class clutchlog
 
             public:
                 //! Empty constructor, only useful for a no-op formatter.
-                fmt() : mode(ansi::colors_16), style(typo::none), fore(fg::none), back(bg::none) {}
+                fmt() : _mode(ansi::colors_16), _style(typo::none), _fore(fg::none), _back(bg::none) {render();}
 
                 /** @name All combination of 16-colors mode constructors with different parameters orders.
                  * @{ */
-                explicit fmt(  fg f,   bg b = bg::none, typo s = typo::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                explicit fmt(  fg f, typo s           ,   bg b =   bg::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                explicit fmt(  bg b,   fg f = fg::none, typo s = typo::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                explicit fmt(  bg b, typo s           ,   fg f =   fg::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                explicit fmt(typo s,   fg f = fg::none,   bg b =   bg::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                explicit fmt(typo s,   bg b           ,   fg f =   fg::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
+                explicit fmt(  fg f,   bg b = bg::none, typo s = typo::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {render();}
+                explicit fmt(  fg f, typo s           ,   bg b =   bg::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {render();}
+                explicit fmt(  bg b,   fg f = fg::none, typo s = typo::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {render();}
+                explicit fmt(  bg b, typo s           ,   fg f =   fg::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {render();}
+                explicit fmt(typo s,   fg f = fg::none,   bg b =   bg::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {render();}
+                explicit fmt(typo s,   bg b           ,   fg f =   fg::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {render();}
                 /** @} */
 
                 /** @name All combination of 256-colors mode constructors with different parameters orders.
                  * @{ */
-                explicit fmt(const short f, const short b, typo s = typo::none) : mode(ansi::colors_256), style(s), fore_256(f),        back_256(b) {}
-                explicit fmt(const short f, typo s = typo::none)                : mode(ansi::colors_256), style(s), fore_256(f),        back_256(bg::none) {}
-                explicit fmt(fg, const short b, typo s = typo::none)            : mode(ansi::colors_256), style(s), fore_256(fg::none), back_256(b) {}
-                explicit fmt(const short f, bg, typo s = typo::none)           : mode(ansi::colors_256), style(s), fore_256(f),       back_256(bg::none) {}
+                explicit fmt(const short f, const short b, typo s = typo::none) : _mode(ansi::colors_256), _style(s), _fore(fg::none), _back(bg::none), fore_256(f),        back_256(b) {render();}
+                explicit fmt(const short f, typo s = typo::none)                : _mode(ansi::colors_256), _style(s), _fore(fg::none), _back(bg::none), fore_256(f),        back_256(bg::none) {render();}
+                explicit fmt(fg, const short b, typo s = typo::none)            : _mode(ansi::colors_256), _style(s), _fore(fg::none), _back(bg::none), fore_256(fg::none), back_256(b) {render();}
+                explicit fmt(const short f, bg, typo s = typo::none)           : _mode(ansi::colors_256), _style(s), _fore(fg::none), _back(bg::none), fore_256(f),       back_256(bg::none) {render();}
                 /** @} */
 
                 /** @name All combination of 16M-colors mode constructors with different parameters orders.
@@ -741,51 +840,79 @@ class clutchlog
                 explicit fmt(const short fr, const short fg, const short fb,
                     const short gr, const short gg, const short gb,
                     typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fr,fg,fb), back_16M(gr,gg,gb) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fr,fg,fb), back_16M(gr,gg,gb) {render();}
                 explicit fmt(fg,
                     const short gr, const short gg, const short gb,
                     typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fg::none), back_16M(gr,gg,gb) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fg::none), back_16M(gr,gg,gb) {render();}
                 explicit fmt(const short fr, const short fg, const short fb,
                     bg, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fr,fg,fb), back_16M(bg::none) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fr,fg,fb), back_16M(bg::none) {render();}
                 explicit fmt(const short fr, const short fg, const short fb,
                     typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fr,fg,fb), back_16M(bg::none) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fr,fg,fb), back_16M(bg::none) {render();}
 
                 explicit fmt(const std::string& f, const std::string& b, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(f), back_16M(b) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(f), back_16M(b) {render();}
                 explicit fmt(fg, const std::string& b, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fg::none), back_16M(b) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fg::none), back_16M(b) {render();}
                 explicit fmt(const std::string& f, bg, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(f), back_16M(bg::none) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(f), back_16M(bg::none) {render();}
                 explicit fmt(const std::string& f, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(f), back_16M(bg::none) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(f), back_16M(bg::none) {render();}
+                /** @} */
+
+                /** @name Accessors
+                 *
+                 * Setters render the escape sequence again.
+                 * Outside of the 16-colors mode, the only sensible colors to set are
+                 * `fg::none` and `bg::none`, which remove the 256 or 16M color.
+                 * @{ */
+                //! Get the ANSI color mode, fixed at construction.
+                ansi mode() const {return _mode;}
+                //! Set the typographic style.
+                void style(const typo s) {_style = s; render();}
+                //! Get the typographic style.
+                typo style() const {return _style;}
+                //! Set the foreground color.
+                void fore(const fg f) {_fore = f; fore_256 = fg_256(f); fore_16M = fg_16M(f); render();}
+                //! Get the foreground color (in 16-colors mode).
+                fg fore() const {return _fore;}
+                //! Set the background color.
+                void back(const bg b) {_back = b; back_256 = bg_256(b); back_16M = bg_16M(b); render();}
+                //! Get the background color (in 16-colors mode).
+                bg back() const {return _back;}
                 /** @} */
 
             protected:
 
-                //! Print the currently encoded format escape code on the given output stream.
-                std::ostream& print_on( std::ostream& os) const
+                //! Render the currently encoded format escape code.
+                void render()
                 {
-                    if(mode == ansi::colors_16) {
+                    _escape.size = 0;
+                    if(_mode == ansi::colors_16) {
                         // Print all in a single escape.
-                        os << std::make_tuple(fore,back,style);
+                        _escape.append_codes({static_cast<short>(_fore), static_cast<short>(_back), static_cast<short>(_style)});
 
                     } else {
                         // 256 or 16M: always print separated escapes for foreground/background.
-                        if(mode == ansi::colors_256) {
-                            os << fore_256;
-                            os << back_256;
+                        if(_mode == ansi::colors_256) {
+                            fore_256.render(_escape);
+                            back_256.render(_escape);
 
-                        } else if(mode == ansi::colors_16M) {
-                            os << fore_16M;
-                            os << back_16M;
+                        } else if(_mode == ansi::colors_16M) {
+                            fore_16M.render(_escape);
+                            back_16M.render(_escape);
                         }
                         // In any case, print the style separately.
-                        os << style;
+                        _escape.append_codes({static_cast<short>(_style)});
                     }
-                    return os;
+                }
+
+                //! Print the currently encoded format escape code on the given output stream.
+                std::ostream& print_on( std::ostream& os) const
+                {
+                    return os.write(_escape.data, _escape.size);
                 }
 
             public:
@@ -817,26 +944,41 @@ class clutchlog
                  */
                 std::string operator()( const std::string& msg ) const
                 {
-                    std::ostringstream os;
-                    this->print_on(os);
-                    fmt reset(fmt::typo::reset);
-                    os << msg;
-                    reset.print_on(os);
-                    return os.str();
+                    std::string styled;
+                    styled.reserve(_escape.size + msg.size() + reset_escape.size());
+                    styled += escape();
+                    styled += msg;
+                    styled += reset_escape;
+                    return styled;
                 }
 
                 /** Return the formatting code as a string.
                  */
                 std::string str() const
                 {
-                    std::ostringstream os;
-                    this->print_on(os);
-                    return os.str();
+                    return std::string(escape());
+                }
+
+                /** Return the formatting code, without copying it.
+                 *
+                 * @note The view is valid as long as the formatter is alive.
+                 */
+                std::string_view escape() const
+                {
+                    return std::string_view(_escape.data, _escape.size);
                 }
 
-                static fmt hash( const std::string& str, const std::vector<fmt> domain = {})
+                //! The escape code resetting any style.
+                static constexpr std::string_view reset_escape = "\033[0m";
+
+                static fmt hash( const std::string& str, const std::vector<fmt>& domain = {})
+                {
+                    return hash(std::hash<std::string>{}(str), domain);
+                }
+
+                //! Style chosen among `domain` (or among the 256 colors, if it is empty) for the given hash value.
+                static fmt hash( const size_t h, const std::vector<fmt>& domain = {})
                 {
-                    size_t h = std::hash<std::string>{}(str);
                     if(domain.size() == 0) {
                         return fmt(static_cast<short>(h % 256));
                     } else {
@@ -847,660 +989,4092 @@ class clutchlog
 
         /** @} */
 
-    /** @name Internal details
-     * @{ */
-
-    public:
-        clutchlog(clutchlog const&)      = delete;
-        void operator=(clutchlog const&) = delete;
+        /** @addtogroup Formating Formating tools
+         * @{ */
 
-    private:
-        clutchlog() :
-            // system, main, log
-            _strip_calls(clutchlog::default_strip_calls),
-            _level_word({
-                {level::critical,"Critical"},
-                {level::error   ,"Error"},
-                {level::warning ,"Warning"},
-                {level::progress,"Progress"},
-                {level::note    ,"Note"},
-                {level::info    ,"Info"},
-                {level::debug   ,"Debug"},
-                {level::xdebug  ,"XDebug"}
-            }),
-            _level_short({
-                {level::critical, "Crit"},
-                {level::error   , "Erro"},
-                {level::warning , "Warn"},
-                {level::progress, "Prog"},
-                {level::note    , "Note"},
-                {level::info    , "Info"},
-                {level::debug   , "Dbug"},
-                {level::xdebug  , "XDbg"}
-            }),
-            _level_fmt({
-                {level::critical,fmt(fmt::fg::red,     fmt::typo::underline)},
-                {level::error   ,fmt(fmt::fg::red,     fmt::typo::bold)},
-                {level::warning ,fmt(fmt::fg::magenta, fmt::typo::bold)},
-                {level::progress,fmt()},
-                {level::note    ,fmt()},
-                {level::info    ,fmt()},
-                {level::debug   ,fmt()},
-                {level::xdebug  ,fmt()}
-            }),
-            _format_log(clutchlog::default_format),
-            _format_dump(clutchlog::dump_default_format),
-            #if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
-                _hfill_char(clutchlog::default_hfill_char),
-                _hfill_fmt(fmt::fg::none),
-                _hfill_max(clutchlog::default_hfill_max),
-                _hfill_min(clutchlog::default_hfill_min),
-            #endif
-            _out(&std::clog),
-            #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-                _depth(std::numeric_limits<size_t>::max() - _strip_calls),
-                _depth_mark(clutchlog::default_depth_mark),
-            #endif
-            _stage(level::error),
-            _in_file(".*"),
-            _in_func(".*"),
-            _in_line(".*"),
-            // Empty vectors by default:
-            // _filehash_fmts
-            // _funchash_fmts
-            // _depth_fmts
-            _filename(filename::path)
-        {
-            // Reverse the level->word map into a word->level map.
-            for(auto& lw : _level_word) {
-                _word_level[lw.second] = lw.first;
-            }
-#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
-            struct winsize w;
-            ioctl(STDERR_FILENO, TIOCGWINSZ, &w);
-            _nb_columns = std::max(std::min((size_t)w.ws_col, default_hfill_max), default_hfill_min);
+        /** A format template, parsed once into a sequence of tokens.
+         *
+         * Each token is either a literal span of the template string,
+         * or a tag that is substituted when a message is formatted.
+         * Formatting a message is thus a single linear pass over the tokens,
+         * appending into a single output buffer.
+         */
+        struct format_t {
+            //! Kinds of tokens.
+            enum class tag : unsigned char {
+                literal,
+                msg, file, func, line,
+                level, level_letter, level_short,
+                name, depth, depth_marks, depth_fmt,
+                level_fmt, filehash_fmt, funchash_fmt,
+                hfill
+            };
+
+            //! A token of the parsed template.
+            struct token_t {
+                /** Kind of token. */
+                tag type;
+                /** Start of the literal span within the template (unused for other tags). */
+                size_t pos;
+                /** Length of the literal span within the template (unused for other tags). */
+                size_t len;
+                /** Display width of the literal span (unused for other tags). */
+                size_t width;
+            };
+
+            /** The template string itself. */
+            std::string source;
+            /** The parsed sequence of tokens. */
+            std::vector<token_t> tokens;
+            /** Set of the tags found in the template (one bit per tag). */
+            unsigned long mask;
+
+            //! Empty constructor: no-op template.
+            format_t() : mask(0) {}
+
+            //! Returns true if the template contains the given tag.
+            bool uses(const tag t) const { return mask & (1ul << static_cast<unsigned>(t)); }
+
+            //! Returns true if the template contains a tag which needs the stack depth.
+            bool uses_depth() const { return uses(tag::depth) or uses(tag::depth_marks) or uses(tag::depth_fmt); }
+
+            /** Call `found` on each token of the given template string, in order.
+             *
+             * This can be done at compile time, see `compiled`.
+             */
+            template<class F>
+            static constexpr void tokenize(const std::string_view form, F found)
+            {
+                constexpr std::pair<std::string_view,tag> tags[] = {
+                    {"{msg}"         , tag::msg},
+                    {"{file}"        , tag::file},
+                    {"{func}"        , tag::func},
+                    {"{line}"        , tag::line},
+                    {"{level}"       , tag::level},
+                    {"{level_letter}", tag::level_letter},
+                    {"{level_short}" , tag::level_short},
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                    {"{name}"        , tag::name},
+                    {"{depth}"       , tag::depth},
+                    {"{depth_marks}" , tag::depth_marks},
+                    {"{depth_fmt}"   , tag::depth_fmt},
 #endif
-        }
+                    {"{level_fmt}"   , tag::level_fmt},
+                    {"{filehash_fmt}", tag::filehash_fmt},
+                    {"{funchash_fmt}", tag::funchash_fmt},
+                    {"{hfill}"       , tag::hfill}
+                };
 
-    protected:
-        /** Current number of call stack levels to remove from depth display. */
-        size_t _strip_calls;
-        /** Dictionary of level identifier to their string representation. */
-        const std::map<level,std::string> _level_word;
-        /** Dictionary of level string to their identifier. */
-        std::map<std::string,level> _word_level;
-        /** dictionary of level identifier to their 4-letters representation. */
-        std::map<level,std::string> _level_short;
-        /** Dictionary of level identifier to their format. */
-        std::map<level,fmt> _level_fmt;
-        /** Current format of the standard output. */
-        std::string _format_log;
-        /** Current format of the file output. */
-        std::string _format_dump;
-        #if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
-            /** Character for filling. */
-            char _hfill_char;
-            /** Style of the filling. */
-            fmt _hfill_fmt;
-            /** Maximum width for which to hfill. */
-            size_t _hfill_max;
-            /** Minimum width at which to hfill. */
-            size_t _hfill_min;
-        #endif
-        /** Standard output. */
-        std::ostream* _out;
-        #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-            /** Current stack depth (above which logs are not printed). */
-            size_t _depth;
-            /** Current depth mark. */
-            std::string _depth_mark;
-        #endif
-        /** Current log level. */
-        level _stage;
-        /** Current file location filter. */
-        std::regex _in_file;
-        /** Current function location filter. */
-        std::regex _in_func;
-        /** Current line location filter. */
-        std::regex _in_line;
+                size_t start = 0; // Start of the current literal span.
+                size_t pos = form.find('{');
+                while(pos != std::string_view::npos) {
+                    bool is_tag = false;
+                    for(const auto& [mark, type] : tags) {
+                        if(form.substr(pos, mark.size()) == mark) {
+                            if(pos > start) {
+                                found(token_t{tag::literal, start, pos - start, width(form.substr(start, pos - start))});
+                            }
+                            found(token_t{type, 0, 0, 0});
+                            start = pos + mark.size();
+                            is_tag = true;
+                            break;
+                        }
+                    }
+                    pos = form.find('{', is_tag ? start : pos + 1);
+                }
+                if(start < form.size()) {
+                    found(token_t{tag::literal, start, form.size() - start, width(form.substr(start))});
+                }
+            }
 
-        /** List of candidate format objects for value-dependant file name styling. */
-        std::vector<fmt> _filehash_fmts;
-        /** List of candidate format objects for value-dependant function name styling. */
-        std::vector<fmt> _funchash_fmts;
+            /** Number of columns taken by the given string once displayed.
+             *
+             * ANSI escape sequences are not counted,
+             * and UTF-8 multi-byte characters count as one column.
+             *
+             * @note Wide characters (e.g. CJK or emojis) are counted as one column, too.
+             */
+            static constexpr size_t width(const std::string_view str)
+            {
+                size_t w = 0;
+                size_t i = 0;
+                while(i < str.size()) {
+                    const unsigned char c = str[i];
+                    // Control Sequence Introducer: either "\x9B" or "\x1B[".
+                    size_t j = i;
+                    if(c == 0x9B) {
+                        j += 1;
+                    } else if(c == 0x1B and i+1 < str.size() and str[i+1] == '[') {
+                        j += 2;
+                    } else {
+                        // A (possibly multi-byte) character.
+                        w++;
+                        if(     (c & 0xE0) == 0xC0) { i += 2; }
+                        else if((c & 0xF0) == 0xE0) { i += 3; }
+                        else if((c & 0xF8) == 0xF0) { i += 4; }
+                        else                        { i += 1; }
+                        continue;
+                    }
+                    // Parameter bytes, then intermediate bytes, then a single final byte.
+                    while(j < str.size() and '0' <= str[j] and str[j] <= '?') { j++; }
+                    while(j < str.size() and ' ' <= str[j] and str[j] <= '/') { j++; }
+                    if(j < str.size() and '@' <= str[j] and str[j] <= '~') {
+                        i = j+1;
+                    } else {
+                        // Not an escape sequence, after all.
+                        w++;
+                        i++;
+                    }
+                }
+                return w;
+            }
 
-#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-        /** Maximum buffer size for backtrace message. */
-        static const size_t _max_buffer = 4096;
-        /** Ordered list of format objects for value-dependant depth styling. */
-        std::vector<fmt> _depth_fmts;
-#endif
+            //! The given string, without its ANSI escape sequences.
+            static std::string unstyled(const std::string_view str)
+            {
+                std::string plain;
+                plain.reserve(str.size());
+                size_t i = 0;
+                while(i < str.size()) {
+                    const unsigned char c = str[i];
+                    size_t j = i;
+                    if(c == 0x9B) {
+                        j += 1;
+                    } else if(c == 0x1B and i+1 < str.size() and str[i+1] == '[') {
+                        j += 2;
+                    } else {
+                        plain += str[i++];
+                        continue;
+                    }
+                    while(j < str.size() and '0' <= str[j] and str[j] <= '?') { j++; }
+                    while(j < str.size() and ' ' <= str[j] and str[j] <= '/') { j++; }
+                    if(j < str.size() and '@' <= str[j] and str[j] <= '~') {
+                        i = j+1;
+                    } else {
+                        plain += str[i++];
+                    }
+                }
+                return plain;
+            }
 
-#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
-        /** Current terminal size (for right-alignment). */
-        size_t _nb_columns;
-#endif
+            //! Returns true if the given tag only inserts styles, which are not displayed.
+            static constexpr bool is_style(const tag t)
+            {
+                return t == tag::level_fmt or t == tag::filehash_fmt or t == tag::funchash_fmt
+                    or t == tag::depth_fmt or t == tag::hfill;
+            }
 
-        /** Filename rendering method. */
-        filename _filename;
-    /** @} Internal details */
+            //! Parse the given template string.
+            explicit format_t(const std::string& form) : source(form), mask(0)
+            {
+                tokenize(source, [this](const token_t& token) {
+                    tokens.push_back(token);
+                    mask |= 1ul << static_cast<unsigned>(token.type);
+                });
+            }
 
-    public:
+            /** A template string parsed at compile time.
+             *
+             * The template should be a `constexpr char[]` with static storage, for instance:
+             * @code
+             * static constexpr char my_format[] = "{level}: {msg}\n";
+             * using parsed = clutchlog::format_t::compiled<my_format>;
+             * @endcode
+             */
+            template<const char* form>
+            struct compiled {
+                /** The template string. */
+                static constexpr std::string_view source = form;
+
+                //! Number of tokens of the template.
+                static constexpr size_t count()
+                {
+                    size_t n = 0;
+                    tokenize(source, [&n](const token_t&) { n++; });
+                    return n;
+                }
 
-        /** @name Configuration accessors
-         * @{ */
+                /** Number of tokens of the template. */
+                static constexpr size_t size = count();
 
-        //! Set the template string.
-        void format(const std::string& format) {_format_log = format;}
-        //! Get the template string.
-        std::string format() const {return _format_log;}
+                //! Parsed tokens of the template.
+                static constexpr std::array<token_t,size> parse()
+                {
+                    std::array<token_t,size> parsed{};
+                    size_t i = 0;
+                    tokenize(source, [&parsed,&i](const token_t& token) { parsed[i++] = token; });
+                    return parsed;
+                }
 
-        //! Set the template string for dumps.
-        void format_comment(const std::string& format) {_format_dump = format;}
-        //! Get the template string for dumps.
-        std::string format_comment() const {return _format_dump;}
+                /** The parsed sequence of tokens. */
+                static constexpr std::array<token_t,size> tokens = parse();
 
-        //! Set the output stream on which to print.
-        void out(std::ostream& out) {_out = &out;}
-        //! Get the output stream on which to print.
-        std::ostream& out() {return *_out;}
+                //! Returns true if the template has an hfill tag.
+                static constexpr bool has_hfill()
+                {
+                    for(const token_t& token : tokens) {
+                        if(token.type == tag::hfill) { return true; }
+                    }
+                    return false;
+                }
+            };
+        }; // format_t
 
-#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-        //! Set the stack depth above which logs are not printed.
-        void depth(size_t d) {
-            _depth = std::min(d, std::numeric_limits<size_t>::max() - _strip_calls);
-        }
-        //! Get the stack depth above which logs are not printed.
-        size_t depth() const {return _depth;}
+        /** @} */
 
-        //! Set the string mark with which stack depth is indicated.
-        void depth_mark(const std::string mark) {_depth_mark = mark;}
-        //! Get the string mark with which stack depth is indicated.
-        std::string depth_mark() const {return _depth_mark;}
+        /** @addtogroup Outputs Output streams
+         * @{ */
 
-        //! Set the number of stack calls which are removed for computing depth. */
-        void strip_calls(const size_t n) {_strip_calls = n;}
-        //! Get the number of stack calls which are removed for computing depth. */
-        size_t strip_calls() const {return _strip_calls;}
-#endif
-#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL == 1
-        //! Set the character for the stretching `{hfill}` template tag marker.
-        void hfill_mark(const char mark) {_hfill_char = mark;}
-        //! Get the character for the stretching `{hfill}` template tag marker.
-        char hfill_mark() const {return _hfill_char;}
-        //! Set the style for the stretching `{hfill}` template tag marker, with a `fmt` object.
-        void hfill_style(fmt style) {_hfill_fmt = style;}
-        /** Set the style for the stretching hfill marker.
-         *
-         * This version accept style arguments as if they were passed to `clutchlog::fmt`.
-         */
-        template<class ... FMT>
-        void hfill_style(FMT... styles) { this->hfill_style(fmt(styles...)); }
-        //! Get the character for the stretching `{hfill}` template tag marker.
-        fmt hfill_style() const {return _hfill_fmt;}
-        //! Set the maximum width for which to `{hfill}`.
-        void hfill_max(const size_t nmax) {_hfill_max = nmax;}
-        //! Get the maximum width for which to `{hfill}`.
-        size_t hfill_max() {return _hfill_max;}
-        //! Set the minimum width at which to `{hfill}`.
-        void hfill_min(const size_t nmin) {_hfill_min = nmin;}
-        //! Get the minimum width at which to `{hfill}`.
-        size_t hfill_min() {return _hfill_min;}
-#endif
-        /** Set the candidate styles for value-dependant file name formatting.
-         *
-         *   Style will be chosen based on the hash value of the filename
-         *   among the candidate ones.
-         *
-         *   See the `{filehash_fmt}` template tag.
-         */
-        void filehash_styles(std::vector<fmt> styles) {_filehash_fmts = styles;}
-        /** Set the candidate styles for value-dependant function name formatting.
+        /** A log file which rotates when it gets too big or too old.
          *
-         *   Style will be chosen based on the hash value of the filename
-         *   among the candidate ones.
+         * It is a `std::ostream`, to be given to `clutchlog::out` or `clutchlog::add_sink`.
+         * The active file is `path`, closed generations are renamed `path.1`, `path.2`, etc.
+         * (the largest number being the most recent), and only the `keep` most recent ones are kept.
          *
-         *   See the `{funchash_fmt}` template tag.
-         */
-        void funchash_styles(std::vector<fmt> styles) {_funchash_fmts = styles;}
-        /** Set the styles for value-dependant depth formatting.
+         * Closed generations are compressed (as `path.N.gz`) and pruned by a background thread,
+         * so that writing never waits for them.
+         * Compression needs `CLUTCHLOG_WITH_ZLIB` to be set to 1,
+         * without it, the generations are kept as is.
          *
-         *   The given list should be ordered, styles will be applied
-         *   for the corresponding depth level. If the actual depth is
-         *   larger than the number of styles, the last one is used.
+         * Rotation only happens in between two messages,
+         * as clutchlog writes each message at once.
          *
-         *   See the `{depth_fmt}` template tag.
+         * @code
+         * // Rotate every 100 MB or every hour, keep the last 10 files.
+         * clutchlog::rotating_file file("run.log", 100*1024*1024, std::chrono::hours(1), 10);
+         * log.out(file);
+         * @endcode
          */
-        void depth_styles(std::vector<fmt> styles) {_depth_fmts = styles;}
+        class rotating_file : public std::ostream {
+            protected:
+                /** Stream buffer which rotates the underlying file. */
+                class buffer_t : public std::streambuf {
+                    protected:
+                        /** The active file. */
+                        std::filebuf _file;
+                        /** Owner, which does the rotations. */
+                        rotating_file& _owner;
+
+                        std::streamsize xsputn(const char* str, std::streamsize n) override
+                        {
+                            _owner.rotate_if_due();
+                            _owner._size += n;
+                            return _file.sputn(str, n);
+                        }
 
-        //! Set the log level (below which logs are not printed) with an identifier.
-        void  threshold(level l) {_stage = l;}
-        //! Set the log level (below which logs are not printed) with a string.
-        void  threshold(const std::string& l) {_stage = this->level_of(l);}
-        //! Get the log level below which logs are not printed.
-        level threshold() const {return _stage;}
-        //! Get the map of available log levels string representations toward their identifier. */
-        const std::map<std::string,level>& levels() const { return _word_level;}
+                        int_type overflow(int_type c) override
+                        {
+                            if(traits_type::eq_int_type(c, traits_type::eof())) {
+                                return traits_type::not_eof(c);
+                            }
+                            _owner.rotate_if_due();
+                            _owner._size++;
+                            return _file.sputc(traits_type::to_char_type(c));
+                        }
 
-        /** Return the log level tag corresponding to the given pre-configured name.
-         *
-         * @note This is case sensitive, see the pre-configured `_level_word`.
-         */
+                        int sync() override { return _file.pubsync(); }
+
+                    public:
+                        //! Constructor.
+                        buffer_t(rotating_file& owner) : _owner(owner) {}
+                        //! The active file.
+                        std::filebuf& file() { return _file; }
+                };
+
+                /** Path of the active file. */
+                const std::string _path;
+                /** Size above which the file rotates (zero for no limit). */
+                const size_t _max_size;
+                /** Age above which the file rotates (zero for no limit). */
+                const std::chrono::seconds _max_age;
+                /** Number of closed generations to keep. */
+                const size_t _keep;
+                /** True if closed generations are compressed. */
+                const bool _compress;
+                /** Size of the active file. */
+                size_t _size;
+                /** Opening time of the active file (or of the last failed rotation). */
+                std::chrono::steady_clock::time_point _opened;
+                /** Size above which the active file rotates next (the maximum size, unless a rotation failed). */
+                size_t _rotate_size;
+                /** Number of the last closed generation. */
+                size_t _generation;
+                /** Stream buffer. */
+                buffer_t _buffer;
+
+                /** Closed generations waiting to be compressed and pruned. */
+                std::vector<size_t> _closed;
+                /** Guards `_closed` and `_stop`. */
+                std::mutex _mutex;
+                /** Wakes up the background thread. */
+                std::condition_variable _wakeup;
+                /** Wakes up the threads waiting in `settle`. */
+                std::condition_variable _settled;
+                /** True if the background thread should stop, once it has processed the closed generations. */
+                bool _stop;
+                /** True while the background thread processes a generation. */
+                bool _busy;
+                /** Background thread, compressing and pruning the closed generations. */
+                std::thread _worker;
+
+                //! Path of the given generation.
+                std::string generation_path(const size_t n) const { return _path + "." + std::to_string(n); }
+
+                //! Call `f(number, path)` for each existing generation file (compressed or not, directories excluded).
+                template<class F>
+                void each_generation(F f) const
+                {
+                    const fs::path path(_path);
+                    const std::string prefix = path.filename().string() + ".";
+                    std::error_code err;
+                    fs::directory_iterator entries(path.has_parent_path() ? path.parent_path() : fs::path("."), err);
+                    for(; not err and entries != fs::directory_iterator(); entries.increment(err)) {
+                        const std::string entry = entries->path().filename().string();
+                        std::error_code type_err;
+                        if(entry.compare(0, prefix.size(), prefix) != 0 or not entries->is_regular_file(type_err)) {
+                            continue;
+                        }
+                        const size_t end = entry.find_first_not_of("0123456789", prefix.size());
+                        const size_t digits = (end == std::string::npos ? entry.size() : end) - prefix.size();
+                        if(digits == 0 or digits > std::numeric_limits<size_t>::digits10
+                           or (end != std::string::npos and entry.compare(end, std::string::npos, ".gz") != 0)) {
+                            continue;
+                        }
+                        f(static_cast<size_t>(std::stoul(entry.substr(prefix.size(), digits))), entries->path());
+                    }
+                }
+
+                //! Largest generation number among the existing files (zero if none).
+                size_t last_generation() const
+                {
+                    size_t last = 0;
+                    each_generation([&last](const size_t n, const fs::path&) { last = std::max(last, n); });
+                    return last;
+                }
+
+                //! Remove all the generations up to the given one (included).
+                void prune(const size_t upto) const
+                {
+                    std::vector<fs::path> old;
+                    each_generation([&old,upto](const size_t n, const fs::path& path) {
+                        if(n <= upto) { old.push_back(path); }
+                    });
+                    for(const fs::path& path : old) {
+                        std::error_code err;
+                        fs::remove(path, err);
+                    }
+                }
+
+                //! Open the active file, appending to it if it exists.
+                void open()
+                {
+                    _buffer.file().open(_path, std::ios::out | std::ios::app | std::ios::binary);
+                    std::error_code err;
+                    const auto size = fs::file_size(_path, err);
+                    _size = err ? 0 : size;
+                    _opened = std::chrono::steady_clock::now();
+                    _rotate_size = _max_size;
+                }
+
+                //! Rotate the file if it is too big or too old.
+                void rotate_if_due()
+                {
+                    if((_max_size > 0 and _size >= _rotate_size)
+                       or (_max_age.count() > 0 and std::chrono::steady_clock::now() - _opened >= _max_age)) {
+                        rotate();
+                    }
+                }
+
+                //! Compress the given generation, then remove the uncompressed file.
+                void compress(const size_t n) const
+                {
+#if CLUTCHLOG_WITH_ZLIB == 1
+                    const std::string from = generation_path(n);
+                    std::ifstream in(from, std::ios::binary);
+                    gzFile out = gzopen((from + ".gz").c_str(), "wb");
+                    if(not in or not out) {
+                        if(out) { gzclose(out); }
+                        return;
+                    }
+                    std::vector<char> chunk(1 << 16);
+                    while(in) {
+                        in.read(chunk.data(), chunk.size());
+                        if(in.gcount() > 0) {
+                            gzwrite(out, chunk.data(), static_cast<unsigned>(in.gcount()));
+                        }
+                    }
+                    if(gzclose(out) == Z_OK) {
+                        std::error_code err;
+                        fs::remove(from, err);
+                    }
+#else
+                    (void)n; // Nothing to compress with.
+#endif
+                }
+
+                //! Loop of the background thread.
+                void run()
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    while(true) {
+                        _wakeup.wait(lock, [this]{ return _stop or not _closed.empty(); });
+                        if(_closed.empty() and _stop) {
+                            break;
+                        }
+                        const size_t n = _closed.front();
+                        _closed.erase(_closed.begin());
+                        _busy = true;
+                        lock.unlock();
+
+                        if(_compress) {
+                            compress(n);
+                        }
+                        if(n > _keep) {
+                            prune(n - _keep);
+                        }
+
+                        lock.lock();
+                        _busy = false;
+                        if(_closed.empty()) {
+                            _settled.notify_all();
+                        }
+                    }
+                }
+
+            public:
+                /** Constructor, opens (or appends to) the given file.
+                 *
+                 * @param path Path of the active file.
+                 * @param max_size Size (in bytes) above which the file rotates (zero for no limit).
+                 * @param max_age Age above which the file rotates (zero for no limit).
+                 * @param keep Number of closed generations to keep.
+                 * @param compress Compress the closed generations (if `CLUTCHLOG_WITH_ZLIB` is set).
+                 */
+                rotating_file(
+                        const std::string& path,
+                        const size_t max_size,
+                        const std::chrono::seconds max_age = std::chrono::seconds(0),
+                        const size_t keep = 5,
+                        const bool compress = true
+                    ) :
+                    std::ostream(nullptr),
+                    _path(path),
+                    _max_size(max_size),
+                    _max_age(max_age),
+                    _keep(keep),
+                    _compress(compress),
+                    _size(0),
+                    _opened(std::chrono::steady_clock::now()),
+                    _rotate_size(max_size),
+                    _generation(last_generation()),
+                    _buffer(*this),
+                    _stop(false),
+                    _busy(false),
+                    _worker(&rotating_file::run, this)
+                {
+                    open();
+                    rdbuf(&_buffer);
+                    if(not _buffer.file().is_open()) {
+                        setstate(std::ios::badbit);
+                    }
+                }
+
+                //! Destructor, closes the file and waits for the background compressions.
+                ~rotating_file()
+                {
+                    _buffer.file().close();
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _stop = true;
+                    }
+                    _wakeup.notify_one();
+                    _worker.join();
+                }
+
+                /** Close the active file as a new generation, and open a new one.
+                 *
+                 * If the file cannot be renamed, writing goes on in the same file,
+                 * and the next rotation is only tried once it has grown by the maximum size again
+                 * (or gotten as old as the maximum age again).
+                 *
+                 * Should be called by the thread which writes (i.e. not concurrently with a message).
+                 */
+                void rotate()
+                {
+                    _buffer.file().close();
+                    std::error_code err;
+                    fs::rename(_path, generation_path(_generation + 1), err);
+                    if(not err) {
+                        _generation++;
+                        {
+                            std::lock_guard<std::mutex> lock(_mutex);
+                            _closed.push_back(_generation);
+                        }
+                        _wakeup.notify_one();
+                    }
+                    open();
+                    if(err) {
+                        _rotate_size = _size + _max_size;
+                    }
+                }
+
+                //! Number of the last closed generation (zero if none).
+                size_t generation() const { return _generation; }
+
+                //! Wait until the closed generations have been compressed and pruned.
+                void settle()
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _settled.wait(lock, [this]{ return _closed.empty() and not _busy; });
+                }
+        }; // rotating_file
+
+        /** @} */
+
+    /** @name Internal details
+     * @{ */
+
+    protected:
+        /** Bounded lock-free queue.
+         *
+         * Any number of threads may push and pop concurrently.
+         * Each cell holds a sequence number telling if it is ready
+         * to be written (by the producers) or read (by the consumer).
+         */
+        template<class T>
+        class ring_t {
+            protected:
+                /** A slot of the queue. */
+                struct cell_t {
+                    /** Position at which the cell is next ready. */
+                    std::atomic<size_t> sequence;
+                    /** Payload. */
+                    T data;
+                };
+                /** Cells of the queue, their number being a power of two. */
+                std::unique_ptr<cell_t[]> _cells;
+                /** Number of cells minus one. */
+                const size_t _mask;
+                /** Next position to push at. */
+                alignas(64) std::atomic<size_t> _enqueue_pos;
+                /** Next position to pop from. */
+                alignas(64) std::atomic<size_t> _dequeue_pos;
+
+                //! Smallest power of two not lower than n (and at least 2).
+                static size_t pow2(const size_t n)
+                {
+                    size_t p = 2;
+                    while(p < n) { p *= 2; }
+                    return p;
+                }
+
+            public:
+                /** Constructor.
+                 *
+                 * @param capacity Minimum number of elements the queue can hold (rounded up to a power of two).
+                 */
+                ring_t(const size_t capacity) :
+                    _cells(new cell_t[pow2(capacity)]),
+                    _mask(pow2(capacity)-1),
+                    _enqueue_pos(0),
+                    _dequeue_pos(0)
+                {
+                    for(size_t i = 0; i <= _mask; ++i) {
+                        _cells[i].sequence.store(i, std::memory_order_relaxed);
+                    }
+                }
+
+                //! Push an element, returns false (and leave it untouched) if the queue is full.
+                bool push(T& data)
+                {
+                    cell_t* cell;
+                    size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+                    while(true) {
+                        cell = &_cells[pos & _mask];
+                        const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                        const long dif = static_cast<long>(seq) - static_cast<long>(pos);
+                        if(dif == 0) {
+                            if(_enqueue_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) {
+                                break;
+                            }
+                        } else if(dif < 0) {
+                            return false; // Full.
+                        } else {
+                            pos = _enqueue_pos.load(std::memory_order_relaxed);
+                        }
+                    }
+                    cell->data = std::move(data);
+                    cell->sequence.store(pos+1, std::memory_order_release);
+                    return true;
+                }
+
+                //! Pop an element, returns false if the queue is empty.
+                bool pop(T& data)
+                {
+                    cell_t* cell;
+                    size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+                    while(true) {
+                        cell = &_cells[pos & _mask];
+                        const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                        const long dif = static_cast<long>(seq) - static_cast<long>(pos+1);
+                        if(dif == 0) {
+                            if(_dequeue_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) {
+                                break;
+                            }
+                        } else if(dif < 0) {
+                            return false; // Empty.
+                        } else {
+                            pos = _dequeue_pos.load(std::memory_order_relaxed);
+                        }
+                    }
+                    data = std::move(cell->data);
+                    cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+                    return true;
+                }
+
+                //! Returns true if no element has been pushed without having been popped.
+                bool empty() const
+                {
+                    return _enqueue_pos.load() == _dequeue_pos.load();
+                }
+        }; // ring_t
+
+        struct sink_t;
+
+        /** Asynchronous writer.
+         *
+         * Formatted messages are pushed in a lock-free queue,
+         * which is drained by a background thread writing on the output streams.
+         */
+        class async_t {
+            public:
+                //! A formatted message, with its destination.
+                struct record_t {
+                    /** Stream to write on (unused if `fd` is set). */
+                    std::ostream* out;
+                    /** Sink to which `out` belongs, skipped once removed, or null for the main output. */
+                    const sink_t* sink;
+                    /** File descriptor to write on, or -1 to write on `out`. */
+                    int fd;
+                    /** Formatted message. */
+                    std::string row;
+                };
+
+                /** Maximum number of messages written by a single system call. */
+                static constexpr size_t max_batch = 64;
+
+            protected:
+                /** Messages waiting to be written. */
+                ring_t<record_t> _queue;
+                /** What to do if the queue is full. */
+                const overflow _policy;
+                /** Number of messages pushed. */
+                std::atomic<size_t> _pushed;
+                /** Number of messages written and flushed, or dropped. */
+                std::atomic<size_t> _done;
+                /** Number of messages dropped. */
+                std::atomic<size_t> _dropped;
+                /** True if the writer should stop, once the queue is empty. */
+                std::atomic<bool> _stop;
+                /** True if the writer is waiting for messages. */
+                std::atomic<bool> _sleeping;
+                /** Mutex for waking up the writer. */
+                std::mutex _mutex;
+                /** Condition for waking up the writer. */
+                std::condition_variable _wakeup;
+                /** Mutex of the logger, guarding the `removed` flag of the sinks. */
+                std::mutex& _out_mutex;
+                /** Background thread. */
+                std::thread _writer;
+
+                //! Wake up the writer, if it is waiting.
+                void wake()
+                {
+                    if(_sleeping.load()) {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _wakeup.notify_one();
+                    }
+                }
+
+                //! Write the batched messages, which all go to the same file descriptor.
+                static void write_batch(std::vector<record_t>& batch)
+                {
+                    if(batch.empty()) { return; }
+                    std::array<std::string_view,max_batch> pieces;
+                    for(size_t i = 0; i < batch.size(); ++i) {
+                        pieces[i] = batch[i].row;
+                    }
+                    clutchlog::write_fd(batch.front().fd, pieces.data(), batch.size());
+                    batch.clear();
+                }
+
+                //! Loop of the writer thread.
+                void run()
+                {
+                    record_t record;
+                    std::ostream* last = nullptr;
+                    // Held while writing on sinks, so that `remove_sink` cannot return in between.
+                    std::unique_lock<std::mutex> sinks_lock(_out_mutex, std::defer_lock);
+                    // Flush the last stream written on, then let the sinks be removed.
+                    auto settle = [&]() {
+                        if(last != nullptr) {
+                            last->flush();
+                            last = nullptr;
+                        }
+                        if(sinks_lock.owns_lock()) {
+                            sinks_lock.unlock();
+                        }
+                    };
+                    // Consecutive messages for the same file descriptor.
+                    std::vector<record_t> batch;
+                    batch.reserve(max_batch);
+                    while(true) {
+                        const bool stopping = _stop.load();
+                        size_t written = 0;
+                        while(_queue.pop(record)) {
+                            written++;
+                            if(record.fd >= 0) {
+                                settle();
+                                if(not batch.empty() and (batch.front().fd != record.fd or batch.size() == max_batch)) {
+                                    write_batch(batch);
+                                }
+                                batch.push_back(std::move(record));
+                            } else {
+                                write_batch(batch);
+                                if(last != nullptr and last != record.out) {
+                                    settle();
+                                }
+                                if(record.sink != nullptr) {
+                                    if(not sinks_lock.owns_lock()) {
+                                        sinks_lock.lock();
+                                    }
+                                    if(record.sink->removed) {
+                                        continue;
+                                    }
+                                }
+                                *record.out << record.row;
+                                last = record.out;
+                            }
+                        }
+                        write_batch(batch);
+                        settle();
+                        _done += written;
+
+                        if(stopping) {
+                            break;
+                        }
+
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _sleeping.store(true);
+                        if(_queue.empty() and not _stop.load()) {
+                            _wakeup.wait_for(lock, std::chrono::milliseconds(100));
+                        }
+                        _sleeping.store(false);
+                    }
+                }
+
+            public:
+                /** Constructor, starts the writer thread.
+                 *
+                 * @param capacity Maximum number of messages waiting to be written.
+                 * @param policy What to do if the queue is full.
+                 * @param out_mutex Mutex guarding the `removed` flag of the sinks.
+                 */
+                async_t(const size_t capacity, const overflow policy, std::mutex& out_mutex) :
+                    _queue(capacity),
+                    _policy(policy),
+                    _pushed(0),
+                    _done(0),
+                    _dropped(0),
+                    _stop(false),
+                    _sleeping(false),
+                    _out_mutex(out_mutex),
+                    _writer(&async_t::run, this)
+                {}
+
+                //! Destructor, writes all the remaining messages and stops the writer thread.
+                ~async_t()
+                {
+                    _stop.store(true);
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _wakeup.notify_one();
+                    }
+                    _writer.join();
+                }
+
+                //! Push a formatted message to be written on the given stream (of the given sink, if any), or file descriptor if it is not -1.
+                void push(std::ostream* out, const sink_t* sink, const int fd, std::string&& row)
+                {
+                    record_t record{out, sink, fd, std::move(row)};
+                    while(not _queue.push(record)) {
+                        if(_policy == overflow::drop_newest) {
+                            _dropped++;
+                            return;
+                        } else if(_policy == overflow::drop_oldest) {
+                            record_t oldest;
+                            if(_queue.pop(oldest)) {
+                                _dropped++;
+                                _done++;
+                            }
+                        } else { // overflow::block
+                            wake();
+                            std::this_thread::yield();
+                        }
+                    }
+                    _pushed++;
+                    wake();
+                }
+
+                //! Wait until all the messages pushed so far have been written and flushed.
+                void drain()
+                {
+                    const size_t target = _pushed.load();
+                    while(_done.load() < target) {
+                        wake();
+                        std::this_thread::yield();
+                    }
+                }
+
+                //! Number of messages dropped because the queue was full.
+                size_t dropped() const { return _dropped.load(); }
+        }; // async_t
+
+        /** Location filters.
+         *
+         * Never modified once published, so that it can be read
+         * by any thread without locking.
+         */
+        struct location_t {
+            /** File location filter. */
+            std::regex file;
+            /** Function location filter. */
+            std::regex func;
+            /** Line location filter. */
+            std::regex line;
+            /** Generation of the filters, incremented each time one of them changes. */
+            size_t generation;
+        };
+
+        /** An additional output, with its own threshold and format (see `clutchlog::add_sink`).
+         *
+         * Never freed before the logger, so that a thread still holding
+         * a previous list of sinks can safely read it.
+         */
+        struct sink_t {
+            /** Stream to write on. */
+            std::ostream* out;
+            /** Log level at or below which messages are written. */
+            std::atomic<level> stage;
+            /** Parsed format of the messages. */
+            const format_t format;
+            /** True if the ANSI escape sequences are written. */
+            const bool styled;
+            /** True once removed, after which nothing is written (guarded by `_out_mutex`). */
+            bool removed;
+            /** Number of messages written since the last flush (guarded by `_out_mutex`). */
+            size_t unflushed;
+            /** Time of the last flush (guarded by `_out_mutex`). */
+            std::chrono::steady_clock::time_point last_flush;
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+            /** Cached width of the terminal behind the stream (zero if it is not a terminal). */
+            mutable std::atomic<size_t> nb_columns;
+            /** True if the terminal width should be looked for again. */
+            mutable std::atomic<bool> columns_stale;
+#endif
+            /** Constructor. */
+            sink_t(std::ostream& o, const level s, const std::string& form, const bool with_styles) :
+                out(&o),
+                stage(s),
+                // Styles embedded in the template are removed, too.
+                format(with_styles ? form : format_t::unstyled(form)),
+                styled(with_styles),
+                removed(false),
+                unflushed(0),
+                last_flush(std::chrono::steady_clock::now())
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+                ,
+                nb_columns(0),
+                columns_stale(true)
+#endif
+            {}
+        };
+        //! A list of sinks, published as a whole.
+        using sinks_t = std::vector<sink_t*>;
+
+    public:
+        struct site_t;
+
+    protected:
+        //! The information displayed by the template tags.
+        struct fields_t {
+            /** Message. */
+            const std::string& what;
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            /** Program name. */
+            const std::string& name;
+#endif
+            /** Log level. */
+            const level stage;
+            /** File location. */
+            const std::string_view file;
+            /** Function location. */
+            const std::string_view func;
+            /** Line location. */
+            const size_t line;
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            /** Stack depth, without the stripped calls. */
+            const size_t depth;
+#endif
+            /** Call site, if known (holds precomputed values). */
+            const site_t* site = nullptr;
+            /** Sink for which the row is formatted (null for the output stream). */
+            const sink_t* sink = nullptr;
+        };
+
+        //! Where to insert the hfills in a row being formatted.
+        struct layout_t {
+            /** Number of columns displayed by the row so far (only counted if there is an hfill). */
+            size_t columns = 0;
+            /** Position in the row, and number of columns displayed before, of each hfill. */
+            std::vector<std::pair<size_t,size_t>> hfills;
+        };
+
+        //! A template compiled by `format<form>()`.
+        using compiled_t = void (clutchlog::*)(std::string&, const fields_t&) const;
+
+    public:
+        clutchlog(clutchlog const&)      = delete;
+        void operator=(clutchlog const&) = delete;
+
+    private:
+        clutchlog() :
+            // system, main, log
+            _strip_calls(clutchlog::default_strip_calls),
+            // Indexed by level.
+            _level_word({
+                "Critical",
+                "Error",
+                "Warning",
+                "Progress",
+                "Note",
+                "Info",
+                "Debug",
+                "XDebug"
+            }),
+            _level_short({
+                "Crit",
+                "Erro",
+                "Warn",
+                "Prog",
+                "Note",
+                "Info",
+                "Dbug",
+                "XDbg"
+            }),
+            _level_fmt({
+                fmt(fmt::fg::red,     fmt::typo::underline),
+                fmt(fmt::fg::red,     fmt::typo::bold),
+                fmt(fmt::fg::magenta, fmt::typo::bold),
+                fmt(),
+                fmt(),
+                fmt(),
+                fmt(),
+                fmt()
+            }),
+            _format_log(format_t(clutchlog::default_format)),
+            _format_dump(format_t(clutchlog::dump_default_format)),
+            _format_log_compiled(nullptr),
+            _format_dump_compiled(nullptr),
+            _dumping(dumping::text),
+            _encoding(encoding::formatted),
+            _records_generation(1),
+            _records_due(true),
+            #if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+                _hfill_char(clutchlog::default_hfill_char),
+                _hfill_fmt(fmt::fg::none),
+                _hfill_max(clutchlog::default_hfill_max),
+                _hfill_min(clutchlog::default_hfill_min),
+            #endif
+            _out(&std::clog),
+            _out_fd(-1),
+            #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                _depth(std::numeric_limits<size_t>::max() - _strip_calls),
+                _depth_mark(clutchlog::default_depth_mark),
+            #endif
+            _stage(level::error),
+            _widest(level::error),
+            _location(nullptr),
+            // Empty vectors by default:
+            // _filehash_fmts
+            // _funchash_fmts
+            // _depth_fmts
+            #if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+                _nb_columns(0),
+                _columns_stale(true),
+                _hfill_watch(false),
+            #endif
+            _filename(filename::path),
+            _async_capacity(clutchlog::default_async_capacity),
+            _async_overflow(overflow::block),
+            _async_dropped(0),
+            // No asynchronous writer by default.
+            _flushing(flushing::always),
+            _flush_level(level::error),
+            _flush_n(1),
+            _flush_ms(1000),
+            _unflushed(0),
+            _last_flush(std::chrono::steady_clock::now())
+        {
+            // Reverse the level->word table into a word->level map.
+            for(size_t l = 0; l < nb_levels; ++l) {
+                _word_level[_level_word[l]] = static_cast<level>(l);
+                _level_letter[l] = _level_word[l].at(0);
+            }
+            _locations.emplace_back(new location_t{std::regex(".*"), std::regex(".*"), std::regex(".*"), 1});
+            _location.store(_locations.back().get(), std::memory_order_release);
+            _sink_lists.emplace_back(new sinks_t());
+            _sinks.store(_sink_lists.back().get(), std::memory_order_release);
+#if CLUTCHLOG_STATIC_FORMATS == 1
+            // Unless the defaults have been changed at run time.
+            if(default_format == default_format_static) {
+                format<default_format_static>();
+            }
+            if(dump_default_format == dump_default_format_static) {
+                format_comment<dump_default_format_static>();
+            }
+#endif
+        }
+
+    protected:
+        /** Current number of call stack levels to remove from depth display. */
+        size_t _strip_calls;
+        /** String representation of each level (indexed by level). */
+        std::array<std::string,nb_levels> _level_word;
+        /** First letter of the string representation of each level (indexed by level). */
+        std::array<char,nb_levels> _level_letter;
+        /** Dictionary of level string to their identifier. */
+        std::map<std::string,level> _word_level;
+        /** 4-letters representation of each level (indexed by level). */
+        std::array<std::string,nb_levels> _level_short;
+        /** Format of each level (indexed by level). */
+        std::array<fmt,nb_levels> _level_fmt;
+        /** Current (parsed) format of the standard output. */
+        format_t _format_log;
+        /** Current (parsed) format of the file output. */
+        format_t _format_dump;
+        /** Compiled version of `_format_log`, if it was given at compile time (null otherwise). */
+        compiled_t _format_log_compiled;
+        /** Compiled version of `_format_dump`, if it was given at compile time (null otherwise). */
+        compiled_t _format_dump_compiled;
+        /** Encoding of the dumped containers. */
+        dumping _dumping;
+        /** Encoding of the messages written on the output stream. */
+        std::atomic<encoding> _encoding;
+        /** Incremented each time the output changes, so that call sites are defined again in the new records. */
+        std::atomic<size_t> _records_generation;
+        /** True if the records header has not been written on the current output yet. */
+        mutable std::atomic<bool> _records_due;
+        /** Ensure that the records header is queued before any record, in asynchronous mode. */
+        mutable std::mutex _records_mutex;
+        /** Next number to try, for each dump file name template with the `{n}` tag. */
+        mutable std::map<std::string,size_t> _dump_next;
+        /** Serialize the numbering of dump files. */
+        mutable std::mutex _dump_mutex;
+        #if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+            /** Character for filling. */
+            char _hfill_char;
+            /** Style of the filling. */
+            fmt _hfill_fmt;
+            /** Maximum width for which to hfill. */
+            size_t _hfill_max;
+            /** Minimum width at which to hfill. */
+            size_t _hfill_min;
+        #endif
+        /** Standard output. */
+        std::atomic<std::ostream*> _out;
+        /** File descriptor on which to write instead of `_out`, or -1. */
+        std::atomic<int> _out_fd;
+        /** Messages waiting to be written on `_out_fd` at the next flush (guarded by `_out_mutex`). */
+        mutable std::string _fd_pending;
+        /** Size above which the waiting messages are written, whatever the flushing policy. */
+        static constexpr size_t _fd_buffer = 65536;
+        /** Serialize the writes on the output stream. */
+        mutable std::mutex _out_mutex;
+        #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            /** Current stack depth (above which logs are not printed). */
+            std::atomic<size_t> _depth;
+            /** Current depth mark. */
+            std::string _depth_mark;
+            /** Program name (looked for once, see `name()`). */
+            mutable std::string _name;
+            /** Ensure that the program name is looked for only once. */
+            mutable std::once_flag _name_once;
+        #endif
+        /** Current log level. */
+        std::atomic<level> _stage;
+        /** Widest log level among the output stream and the sinks (messages above it are not even built). */
+        std::atomic<level> _widest;
+        /** Current location filters. */
+        std::atomic<const location_t*> _location;
+        /** All the location filters ever published.
+         *
+         * A thread may still be reading a previous one,
+         * hence they are only freed along with the logger.
+         */
+        std::vector<std::unique_ptr<const location_t>> _locations;
+        /** Serialize the changes of the location filters. */
+        std::mutex _location_mutex;
+        /** All the sinks ever added, indexed by their identifier. */
+        std::vector<std::unique_ptr<sink_t>> _sink_pool;
+        /** Current sinks (published as a whole, like the location filters). */
+        std::atomic<const sinks_t*> _sinks;
+        /** All the lists of sinks ever published (freed along with the logger). */
+        std::vector<std::unique_ptr<const sinks_t>> _sink_lists;
+        /** Serialize the changes of the sinks. */
+        mutable std::mutex _sinks_mutex;
+        /** All the call sites executed so far. */
+        std::vector<site_t*> _sites;
+        /** Serialize the accesses to the call sites registry. */
+        mutable std::mutex _sites_mutex;
+
+        /** List of candidate format objects for value-dependant file name styling. */
+        std::vector<fmt> _filehash_fmts;
+        /** List of candidate format objects for value-dependant function name styling. */
+        std::vector<fmt> _funchash_fmts;
+
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+    #if CLUTCHLOG_DEPTH_SCOPE == 1
+        /** Number of enclosing `CLUTCHSCOPE` in the current thread. */
+        static inline thread_local size_t _scope_depth = 0;
+    #endif
+        /** Maximum buffer size for backtrace message. */
+        static constexpr size_t _max_buffer = 4096;
+        /** Number of frames above which the backtrace buffer is not taken on the stack. */
+        static constexpr size_t _stack_buffer = 64;
+        /** Ordered list of format objects for value-dependant depth styling. */
+        std::vector<fmt> _depth_fmts;
+#endif
+
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+        /** Cached width of the terminal behind the output stream (zero if it is not a terminal). */
+        mutable std::atomic<size_t> _nb_columns;
+        /** True if the terminal width should be looked for again (e.g. the output stream changed). */
+        mutable std::atomic<bool> _columns_stale;
+        /** True if the terminal resizes are watched. */
+        bool _hfill_watch;
+        /** Set by the SIGWINCH handler, consumed by the next `{hfill}`. */
+        static inline std::atomic<bool> _resized = false;
+        /** SIGWINCH action which was installed before `hfill_watch(true)`. */
+        static inline struct sigaction _previous_winch;
+#endif
+
+        /** Filename rendering method. */
+        filename _filename;
+
+        /** Maximum number of messages waiting to be written in asynchronous mode. */
+        size_t _async_capacity;
+        /** What to do if the asynchronous queue is full. */
+        overflow _async_overflow;
+        /** Number of messages dropped by previous asynchronous writers. */
+        size_t _async_dropped;
+        /** Asynchronous writer (null in synchronous mode). */
+        std::unique_ptr<async_t> _async;
+
+        /** When to flush the output stream. */
+        flushing _flushing;
+        /** Log level at or below which to flush (with `flushing::on_level`). */
+        level _flush_level;
+        /** Number of messages after which to flush (with `flushing::every_n`). */
+        size_t _flush_n;
+        /** Duration after which to flush (with `flushing::every_ms`). */
+        std::chrono::milliseconds _flush_ms;
+        /** Number of messages written since the last flush (guarded by `_out_mutex`). */
+        mutable size_t _unflushed;
+        /** Time of the last flush (guarded by `_out_mutex`). */
+        mutable std::chrono::steady_clock::time_point _last_flush;
+    /** @} Internal details */
+
+    public:
+        //! Destructor, writes any message still waiting in asynchronous mode, or on the file descriptor.
+        ~clutchlog()
+        {
+            async(false);
+            std::lock_guard<std::mutex> lock(_out_mutex);
+            if(_out_fd.load() >= 0) {
+                flush_out();
+            }
+        }
+
+    public:
+
+        /** @name Configuration accessors
+         * @{ */
+
+        //! Set the template string.
+        void format(const std::string& format)
+        {
+            _format_log = format_t(format);
+            _format_log_compiled = nullptr;
+        }
+        /** Set the template string at compile time.
+         *
+         * The template is parsed by the compiler, which generates
+         * the sequence of appends corresponding to its tags.
+         * The template should be a `constexpr char[]` with static storage, for instance:
+         * @code
+         * static constexpr char my_format[] = "{level}: {msg}\n";
+         * log.format<my_format>();
+         * @endcode
+         */
+        template<const char* form>
+        void format()
+        {
+            _format_log = format_t(form);
+            _format_log_compiled = &clutchlog::format_compiled<form>;
+        }
+        //! Get the template string.
+        std::string format() const {return _format_log.source;}
+
+        //! Set the template string for dumps.
+        void format_comment(const std::string& format)
+        {
+            _format_dump = format_t(format);
+            _format_dump_compiled = nullptr;
+        }
+        //! Set the template string for dumps at compile time (see `format<form>()`).
+        template<const char* form>
+        void format_comment()
+        {
+            _format_dump = format_t(form);
+            _format_dump_compiled = &clutchlog::format_compiled<form>;
+        }
+        //! Get the template string for dumps.
+        std::string format_comment() const {return _format_dump.source;}
+
+        /** Set the encoding of the dumped containers.
+         *
+         * - `dumping::text`: one item per separator, as written by `operator<<` (the default),
+         * - `dumping::binary`: a header line, the comment line, then the raw bytes of the items.
+         *
+         * The binary encoding only applies to contiguous ranges
+         * (pointers and `std::vector` iterators) of trivially copyable items,
+         * other containers are still dumped as text.
+         * Contiguous items without `operator<<` are dumped in binary whatever the mode.
+         * Use `clutchlog::undump` to convert a binary dump back to text.
+         */
+        void dump_mode(const dumping mode) {_dumping = mode;}
+        //! Get the encoding of the dumped containers.
+        dumping dump_mode() const {return _dumping;}
+
+        /** Set the encoding of the messages written on the output stream (see `out()` and `out_fd()`).
+         *
+         * - `encoding::formatted`: text lines following `format()` (the default),
+         * - `encoding::records`: compact binary records, formatted later by `decode`,
+         * - `encoding::json`: one JSON object per line (JSON Lines),
+         * - `encoding::logfmt`: one line of `key=value` pairs.
+         *
+         * In `records` mode, the messages of the macros are not formatted at all:
+         * arithmetic and string arguments are stored as raw bytes, along with
+         * the identifier of the call site, a time stamp, the stack depth and a thread number.
+         * The file, function, line, level and template of a call site are only written once,
+         * the first time it is logged on the output.
+         *
+         * The `json` and `logfmt` modes ignore the template and the styles, and write the fields
+         * `timestamp` (UTC, RFC 3339), `level`, `name`, `file`, `func`, `line`, `depth` and `message`
+         * (`name` and `depth` only if the system provides them).
+         * The stack depth is then always measured.
+         *
+         * Sinks are still written as text.
+         */
+        void out_mode(const encoding mode)
+        {
+            if(_async) { _async->drain(); }
+            std::lock_guard<std::mutex> lock(_out_mutex);
+            if(_unflushed > 0) {
+                flush_out();
+            }
+            if(mode != _encoding.load()) {
+                _encoding.store(mode);
+                restart_records();
+            }
+        }
+        //! Get the encoding of the messages written on the output stream.
+        encoding out_mode() const {return _encoding.load();}
+
+        //! Set the output stream on which to print (in asynchronous mode, waits for the previous one to be written first).
+        void out(std::ostream& out)
+        {
+            if(_async) { _async->drain(); }
+            std::lock_guard<std::mutex> lock(_out_mutex);
+            if(_unflushed > 0) {
+                flush_out();
+            }
+            _out.store(&out);
+            _out_fd.store(-1);
+            restart_records();
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+            _columns_stale = true;
+#endif
+        }
+        //! Get the output stream on which to print (not used while a file descriptor is set with `out_fd`).
+        std::ostream& out() {return *_out.load();}
+
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+        /** Print directly on the given file descriptor, instead of an output stream.
+         *
+         * Messages are written with `write`/`writev` system calls, bypassing the iostreams.
+         * Unless the flushing policy is `flushing::always`, the messages wait in a buffer
+         * and are written at the next flush, all of them in a single system call.
+         * The descriptor is not closed by the logger.
+         * Set -1 (or call `out(std::ostream&)`) to go back to the output stream.
+         *
+         * @code
+         * log.out_fd(STDERR_FILENO);
+         * @endcode
+         */
+        void out_fd(const int fd)
+        {
+            if(_async) { _async->drain(); }
+            std::lock_guard<std::mutex> lock(_out_mutex);
+            if(_unflushed > 0) {
+                flush_out();
+            }
+            _out_fd.store(fd);
+            restart_records();
+            _columns_stale = true;
+        }
+        //! Get the file descriptor on which to print, or -1 if printing on `out()`.
+        int out_fd() const {return _out_fd.load();}
+#endif
+
+        /** Add an output stream, with its own log level and format, and return its identifier.
+         *
+         * Messages are written on the sinks in addition to `out()`.
+         * The message and the location are computed once for all of them,
+         * and a message is not even built if neither `out()` nor a sink accepts its level.
+         * If `styled` is false, no ANSI escape sequence is written
+         * (including the ones embedded in the template).
+         *
+         * @code
+         * std::ofstream file("run.log");
+         * log.threshold(clutchlog::level::progress); // On the terminal.
+         * log.add_sink(file, clutchlog::level::xdebug, "{level_short} {file}:{line} {msg}\n", false);
+         * @endcode
+         */
+        size_t add_sink(std::ostream& out, const level stage, const std::string& format = default_format, const bool styled = true)
+        {
+            size_t id;
+            {
+                std::lock_guard<std::mutex> lock(_sinks_mutex);
+                _sink_pool.emplace_back(new sink_t(out, stage, format, styled));
+                id = _sink_pool.size() - 1;
+                sink_t* sink = _sink_pool.back().get();
+                publish_sinks([&](sinks_t& sinks){ sinks.push_back(sink); });
+            }
+            widen();
+            return id;
+        }
+
+        /** Stop writing on the given sink.
+         *
+         * In asynchronous mode, waits for its messages to be written first.
+         * Throws `std::out_of_range` if there is no such sink.
+         */
+        void remove_sink(const size_t id)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_sinks_mutex);
+                sink_t* sink = _sink_pool.at(id).get();
+                publish_sinks([&](sinks_t& sinks){
+                    sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+                });
+            }
+            widen();
+            if(_async) { _async->drain(); }
+            std::lock_guard<std::mutex> lock(_out_mutex);
+            sink_t& sink = *_sink_pool.at(id);
+            if(not sink.removed and sink.unflushed > 0) {
+                flush_to(*sink.out, sink.unflushed, sink.last_flush);
+            }
+            sink.removed = true;
+        }
+
+        //! Set the log level at or below which messages are written on the given sink.
+        void sink_threshold(const size_t id, const level stage)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_sinks_mutex);
+                _sink_pool.at(id)->stage.store(stage, std::memory_order_relaxed);
+            }
+            widen();
+        }
+        //! Get the log level at or below which messages are written on the given sink.
+        level sink_threshold(const size_t id) const
+        {
+            std::lock_guard<std::mutex> lock(_sinks_mutex);
+            return _sink_pool.at(id)->stage.load(std::memory_order_relaxed);
+        }
+
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+        //! Set the stack depth above which logs are not printed.
+        void depth(size_t d) {
+            _depth.store(std::min(d, std::numeric_limits<size_t>::max() - _strip_calls), std::memory_order_relaxed);
+        }
+        //! Get the stack depth above which logs are not printed.
+        size_t depth() const {return _depth.load(std::memory_order_relaxed);}
+
+        //! Set the string mark with which stack depth is indicated.
+        void depth_mark(const std::string mark) {_depth_mark = mark;}
+        //! Get the string mark with which stack depth is indicated.
+        std::string depth_mark() const {return _depth_mark;}
+
+        //! Set the program name, displayed by the `{name}` template tag.
+        void name(const std::string& n)
+        {
+            std::call_once(_name_once, [](){}); // Do not look for it anymore.
+            _name = n;
+        }
+        /** Get the program name, displayed by the `{name}` template tag.
+         *
+         * Unless set with `name(std::string)`, it is looked for only once,
+         * the first time it is needed.
+         */
+        const std::string& name() const
+        {
+            std::call_once(_name_once, [this](){ _name = process_name(); });
+            return _name;
+        }
+
+        //! Set the number of stack calls which are removed for computing depth. */
+        void strip_calls(const size_t n) {_strip_calls = n;}
+        //! Get the number of stack calls which are removed for computing depth. */
+        size_t strip_calls() const {return _strip_calls;}
+#endif
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL == 1
+        //! Set the character for the stretching `{hfill}` template tag marker.
+        void hfill_mark(const char mark) {_hfill_char = mark;}
+        //! Get the character for the stretching `{hfill}` template tag marker.
+        char hfill_mark() const {return _hfill_char;}
+        //! Set the style for the stretching `{hfill}` template tag marker, with a `fmt` object.
+        void hfill_style(fmt style) {_hfill_fmt = style;}
+        /** Set the style for the stretching hfill marker.
+         *
+         * This version accept style arguments as if they were passed to `clutchlog::fmt`.
+         */
+        template<class ... FMT>
+        void hfill_style(FMT... styles) { this->hfill_style(fmt(styles...)); }
+        //! Get the character for the stretching `{hfill}` template tag marker.
+        fmt hfill_style() const {return _hfill_fmt;}
+        //! Set the maximum width for which to `{hfill}`.
+        void hfill_max(const size_t nmax) {_hfill_max = nmax;}
+        //! Get the maximum width for which to `{hfill}`.
+        size_t hfill_max() {return _hfill_max;}
+        //! Set the minimum width at which to `{hfill}`.
+        void hfill_min(const size_t nmin) {_hfill_min = nmin;}
+        //! Get the minimum width at which to `{hfill}`.
+        size_t hfill_min() {return _hfill_min;}
+        /** Follow the terminal resizes (or stop doing so).
+         *
+         * Installs a SIGWINCH handler which only raises a flag:
+         * the width is looked for again at the next `{hfill}`.
+         * A previously installed handler is still called,
+         * and is restored when watching is disabled.
+         */
+        void hfill_watch(const bool enable)
+        {
+            if(enable and not _hfill_watch) {
+                struct sigaction action;
+                action.sa_sigaction = &clutchlog::on_resize;
+                sigemptyset(&action.sa_mask);
+                action.sa_flags = SA_SIGINFO | SA_RESTART;
+                _hfill_watch = sigaction(SIGWINCH, &action, &_previous_winch) == 0;
+            } else if(not enable and _hfill_watch) {
+                sigaction(SIGWINCH, &_previous_winch, nullptr);
+                _hfill_watch = false;
+            }
+            _columns_stale = true;
+        }
+        //! True if the terminal resizes are followed.
+        bool hfill_watch() const {return _hfill_watch;}
+#endif
+        /** Set the candidate styles for value-dependant file name formatting.
+         *
+         *   Style will be chosen based on the hash value of the filename
+         *   among the candidate ones.
+         *
+         *   See the `{filehash_fmt}` template tag.
+         */
+        void filehash_styles(std::vector<fmt> styles) {_filehash_fmts = styles;}
+        /** Set the candidate styles for value-dependant function name formatting.
+         *
+         *   Style will be chosen based on the hash value of the filename
+         *   among the candidate ones.
+         *
+         *   See the `{funchash_fmt}` template tag.
+         */
+        void funchash_styles(std::vector<fmt> styles) {_funchash_fmts = styles;}
+        /** Set the styles for value-dependant depth formatting.
+         *
+         *   The given list should be ordered, styles will be applied
+         *   for the corresponding depth level. If the actual depth is
+         *   larger than the number of styles, the last one is used.
+         *
+         *   See the `{depth_fmt}` template tag.
+         */
+        void depth_styles(std::vector<fmt> styles) {_depth_fmts = styles;}
+
+        //! Set the log level (below which logs are not printed) with an identifier.
+        void  threshold(level l) {_stage.store(l, std::memory_order_relaxed); widen();}
+        //! Set the log level (below which logs are not printed) with a string.
+        void  threshold(const std::string& l) {_stage.store(this->level_of(l), std::memory_order_relaxed); widen();}
+        //! Get the log level below which logs are not printed.
+        level threshold() const {return _stage.load(std::memory_order_relaxed);}
+        //! Get the map of available log levels string representations toward their identifier. */
+        const std::map<std::string,level>& levels() const { return _word_level;}
+
+        /** Set the string representation of the given log level.
+         *
+         * Its first letter is used by the `{level_letter}` template tag,
+         * and the level can then be found by this name with `level_of`
+         * (its previous name is forgotten).
+         */
+        void level_word(const level stage, const std::string& word)
+        {
+            if(word.empty()) {
+                throw std::invalid_argument("the name of a log level cannot be empty");
+            }
+            _word_level.erase(_level_word.at(stage));
+            _level_word.at(stage) = word;
+            _level_letter.at(stage) = word.at(0);
+            _word_level[word] = stage;
+        }
+        //! Get the string representation of the given log level.
+        const std::string& level_word(const level stage) const {return _level_word.at(stage);}
+
+        //! Set the short (usually 4-letters) representation of the given log level.
+        void level_short(const level stage, const std::string& word) {_level_short.at(stage) = word;}
+        //! Get the short representation of the given log level.
+        const std::string& level_short(const level stage) const {return _level_short.at(stage);}
+
+        /** Return the log level tag corresponding to the given pre-configured name.
+         *
+         * @note This is case sensitive, see the pre-configured `_level_word`.
+         */
         level level_of(const std::string name)
         {
-            const auto ilevel = _word_level.find(name);
-            if( ilevel != std::end(_word_level)) {
-                return ilevel->second;
+            const auto ilevel = _word_level.find(name);
+            if( ilevel != std::end(_word_level)) {
+                return ilevel->second;
+            } else {
+                throw std::out_of_range("'" + name + "' is not a valid log level name");
+            }
+        }
+
+        //! Set the regular expression filtering the file location.
+        void file(std::string file) {relocate([&](location_t& loc){ loc.file = file; });}
+        //! Set the regular expression filtering the function location.
+        void func(std::string func) {relocate([&](location_t& loc){ loc.func = func; });}
+        //! Set the regular expression filtering the line location.
+        void line(std::string line) {relocate([&](location_t& loc){ loc.line = line; });}
+
+        //! Set the regular expressions filtering the location.
+        void location(
+                const std::string& in_file,
+                const std::string& in_function=".*",
+                const std::string& in_line=".*"
+            )
+        {
+            relocate([&](location_t& loc){
+                loc.file = in_file;
+                loc.func = in_function;
+                loc.line = in_line;
+            });
+        }
+
+        /** Set the style (color and typo) of the given log level.
+         *
+         * This version accept style arguments as if they were passed to `clutchlog::fmt`.
+         */
+        template<class ... FMT>
+        void style(level stage, FMT... styles) { this->style(stage,fmt(styles...)); }
+        //! Set the style (color and typo) of the given log level, passing a `fmt` instance.
+        void style(level stage, fmt style) { _level_fmt.at(stage) = style; }
+        //! Get the configured fmt instance of the given log level.
+        fmt  style(level stage) const { return _level_fmt.at(stage); }
+
+        //! Sets the file naming scheme. */
+        void filename(filename f) {_filename = f;}
+
+        /** Enable or disable asynchronous writing.
+         *
+         * In asynchronous mode, messages are formatted by the calling thread,
+         * and then written on the output stream by a background thread.
+         * Critical messages are always written (and flushed) before the call returns.
+         * Disabling the asynchronous mode writes all the waiting messages.
+         */
+        void async(const bool enable)
+        {
+            if(enable and not _async) {
+                _async = std::make_unique<async_t>(_async_capacity, _async_overflow, _out_mutex);
+            } else if(not enable and _async) {
+                _async_dropped += _async->dropped();
+                _async.reset(); // Drains the queue.
+            }
+        }
+        //! Returns true if in asynchronous mode.
+        bool async() const {return static_cast<bool>(_async);}
+        //! Set the maximum number of messages waiting to be written in asynchronous mode (applied the next time it is enabled).
+        void async_capacity(const size_t n) {_async_capacity = n;}
+        //! Get the maximum number of messages waiting to be written in asynchronous mode.
+        size_t async_capacity() const {return _async_capacity;}
+        //! Set what to do when the asynchronous queue is full (applied the next time it is enabled).
+        void async_overflow(const overflow policy) {_async_overflow = policy;}
+        //! Get what to do when the asynchronous queue is full.
+        overflow async_overflow() const {return _async_overflow;}
+        //! Get the number of messages dropped so far because the asynchronous queue was full.
+        size_t async_dropped() const {return _async_dropped + (_async ? _async->dropped() : 0);}
+
+        /** Set when to flush the output stream after writing a message:
+         *
+         * - `flushing::always`: after each message (the default),
+         * - `flushing::on_level`: after messages at or below `flush_level`,
+         * - `flushing::every_n`: after every `flush_n` messages,
+         * - `flushing::every_ms`: after the first message written `flush_ms` milliseconds after the last flush,
+         * - `flushing::manual`: only when calling `flush()`.
+         *
+         * Changing the policy first flushes the messages written so far.
+         *
+         * @note In asynchronous mode, the background writer flushes on its own,
+         *       once it has written all the waiting messages.
+         * @note There is no timer: in synchronous mode, `flushing::every_ms` only flushes
+         *       when a message is written, so the last messages of a burst wait
+         *       until the next message, a call to `flush()`, a change of policy
+         *       or the destruction of the logger (for messages waiting on a file descriptor,
+         *       streams being flushed by their own destructor).
+         */
+        void flush_policy(const flushing policy)
+        {
+            if(policy != _flushing) {
+                flush();
+            }
+            _flushing = policy;
+        }
+        //! Get when to flush the output stream.
+        flushing flush_policy() const {return _flushing;}
+        //! Set the log level at or below which to flush (with `flushing::on_level`).
+        void flush_level(const level l) {_flush_level = l;}
+        //! Get the log level at or below which to flush (with `flushing::on_level`).
+        level flush_level() const {return _flush_level;}
+        //! Set the number of messages after which to flush (with `flushing::every_n`).
+        void flush_n(const size_t n) {_flush_n = std::max(n, (size_t)1);}
+        //! Get the number of messages after which to flush (with `flushing::every_n`).
+        size_t flush_n() const {return _flush_n;}
+        //! Set the number of milliseconds after which to flush (with `flushing::every_ms`).
+        void flush_ms(const size_t ms) {_flush_ms = std::chrono::milliseconds(ms);}
+        //! Get the number of milliseconds after which to flush (with `flushing::every_ms`).
+        size_t flush_ms() const {return _flush_ms.count();}
+
+        //! Write all the waiting messages and flush the output stream and the sinks.
+        void flush()
+        {
+            if(_async) { _async->drain(); }
+            std::lock_guard<std::mutex> lock(_out_mutex);
+            flush_out();
+            for(sink_t* sink : *_sinks.load(std::memory_order_acquire)) {
+                if(not sink->removed) {
+                    flush_to(*sink->out, sink->unflushed, sink->last_flush);
+                }
+            }
+        }
+
+        /** @} Configuration accessors */
+
+    public:
+
+        /** @name Low-level API
+         * @{ */
+
+        //! Structure holding a location matching.
+        struct scope_t {
+            /** Everything is compatible. */
+            bool matches;
+            /** Current log level. */
+            level stage;
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            /** Current depth. */
+            size_t depth;
+#endif
+            /** Location is compatible. */
+            bool there;
+            /** The call site is forced on: thresholds do not apply. */
+            bool forced;
+            /** Constructor. */
+            scope_t() :
+                matches(false),
+                stage(level::xdebug),
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                depth(0),
+#endif
+                there(false),
+                forced(false)
+            {}
+        }; // scope_t
+
+        /** Static data of a call site.
+         *
+         * Each call to the macros declares its own static instance,
+         * holding the location of the call and caching
+         * whether it matches the current location filters.
+         *
+         * Call sites register themselves to the logger when first executed,
+         * so that they can be individually switched on or off (see `clutchlog::switch_sites`).
+         */
+        struct site_t {
+            /** Log level of the call. */
+            level stage;
+            /** File of the call. */
+            const char* file;
+            /** Function of the call. */
+            const char* func;
+            /** Line of the call. */
+            size_t line;
+            /** Hash of the file name, for the `{filehash_fmt}` tag (computed at registration). */
+            size_t filehash;
+            /** Hash of the function name, for the `{funchash_fmt}` tag (computed at registration). */
+            size_t funchash;
+            /** File name, as displayed by each `filename` rendering method. */
+            std::array<std::string_view, filename::dirstem+1> filenames;
+            /** Cached location matching, as the generation of the location filters
+             * for which it has been computed (zero for never) shifted by one bit,
+             * with the matching in the lowest bit.
+             *
+             * Held in a single atomic, so that threads sharing the call site never see a torn cache.
+             */
+            std::atomic<size_t> verdict;
+            /** State of the call site (a `switching`), or -1 if it is not registered yet. */
+            std::atomic<int> switched;
+            /** Identifier of the call site in binary records (its rank of registration). */
+            size_t id;
+            /** Generation of the records output on which the call site has been defined (zero for none). */
+            mutable std::atomic<size_t> recorded;
+
+            /** Constructor.
+             *
+             * Being constexpr, the static instances declared by the macros
+             * are initialized at compile time, and do not need any guard.
+             * They register themselves to the logger when first executed.
+             */
+            constexpr site_t(const level& s, const char* in_file, const char* in_func, const size_t in_line) :
+                stage(s),
+                file(in_file),
+                func(in_func),
+                line(in_line),
+                filehash(0),
+                funchash(0),
+                filenames({
+                    filename_of(std::string_view(in_file, length_of(in_file)), filename::path),
+                    filename_of(std::string_view(in_file, length_of(in_file)), filename::base),
+                    filename_of(std::string_view(in_file, length_of(in_file)), filename::dir),
+                    filename_of(std::string_view(in_file, length_of(in_file)), filename::dirbase),
+                    filename_of(std::string_view(in_file, length_of(in_file)), filename::stem),
+                    filename_of(std::string_view(in_file, length_of(in_file)), filename::dirstem)
+                }),
+                verdict(0),
+                switched(-1),
+                id(0),
+                recorded(0)
+            {}
+
+            /** Length of a C string.
+             *
+             * Unlike `std::char_traits::length`, always usable in the constructor's constant evaluation.
+             */
+            static constexpr size_t length_of(const char* str)
+            {
+                size_t n = 0;
+                while(str[n] != '\0') { n++; }
+                return n;
+            }
+
+            /** Whether the call site follows the filters, or is forced on or off (registers the call site if necessary).
+             *
+             * The acquire load makes the hashes and identifier set at registration visible.
+             */
+            switching state()
+            {
+                const int s = switched.load(std::memory_order_acquire);
+                if(s < 0) {
+                    return clutchlog::logger().enroll(*this);
+                }
+                return static_cast<switching>(s);
+            }
+
+            //! Force the call site on or off, or make it follow the filters again.
+            void state(const switching s) {switched.store(s, std::memory_order_release);}
+
+            /** Returns true if a call may be logged, considering only its state and level.
+             *
+             * The other filters are checked by `clutchlog::locate`.
+             */
+            bool passes(const clutchlog& logger)
+            {
+                // Relaxed: nothing else is read here, and `locate` loads the state again
+                // (with acquire) before reading anything set at registration.
+                const int switched_now = switched.load(std::memory_order_relaxed);
+                const switching s = switched_now < 0 ? state() : static_cast<switching>(switched_now);
+                return s == switching::enabled
+                    or (s == switching::follow and stage <= logger._widest.load(std::memory_order_relaxed));
+            }
+        }; // site_t
+
+        //! Get all the call sites executed so far.
+        std::vector<site_t*> sites() const
+        {
+            std::lock_guard<std::mutex> lock(_sites_mutex);
+            return _sites;
+        }
+
+        /** Set the state of the call sites for which `which(const site_t&)` returns true.
+         *
+         * Returns the number of changed call sites.
+         *
+         * @code
+         * // Log everything at lines 40 to 50 of main.cpp, whatever the filters.
+         * log.switch_sites(clutchlog::enabled, [](const clutchlog::site_t& site) {
+         *     return std::string(site.file).find("main.cpp") != std::string::npos
+         *            and 40 <= site.line and site.line <= 50;
+         * });
+         * @endcode
+         */
+        template<class P>
+        size_t switch_sites(const switching state, P which)
+        {
+            std::lock_guard<std::mutex> lock(_sites_mutex);
+            size_t n = 0;
+            for(site_t* site : _sites) {
+                if(which(static_cast<const site_t&>(*site))) {
+                    site->state(state);
+                    n++;
+                }
+            }
+            return n;
+        }
+
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1 and CLUTCHLOG_DEPTH_SCOPE == 1
+        /** Count one level of stack depth during its lifetime.
+         *
+         * Declared by the `CLUTCHSCOPE` macro.
+         */
+        struct depth_t {
+            /** Enter a level. */
+            depth_t() { clutchlog::_scope_depth++; }
+            /** Leave the level. */
+            ~depth_t() { clutchlog::_scope_depth--; }
+        }; // depth_t
+#endif
+
+
+        /** Gather information on the current location of the call.
+         *
+         * @note If `with_depth` is false, the stack depth is only measured
+         *       if a maximum depth has been set.
+         */
+        scope_t locate(
+                const level& stage,
+                const std::string& file,
+                const std::string& func,
+                const size_t line,
+                const bool with_depth = true
+            ) const
+        {
+            scope_t scope; // False scope by default.
+
+            /***** Log level stage *****/
+            // Test stage first, because it's fastest.
+            scope.stage = stage;
+            if(not (scope.stage <= _widest.load(std::memory_order_relaxed))) {
+                // Bypass useless computations if no match
+                // because of the stage.
+                return scope;
+            }
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            /***** Stack depth *****/
+            // Backtrace in second, quite fast.
+            if(not within_depth(scope, with_depth)) {
+                // Bypass if no match.
+                return scope;
+            }
+#endif
+
+            /***** Location *****/
+            // Location last, slowest.
+            scope.there = is_there(*_location.load(std::memory_order_acquire), file.c_str(), func.c_str(), line);
+
+            // No need to retest stage and depth, which are true here.
+            scope.matches = scope.there;
+
+            return scope;
+        } // locate
+
+        /** Gather information on the location of the given call site.
+         *
+         * The location matching is only computed once per call site,
+         * until the location filters change.
+         *
+         * @note If `with_depth` is false, the stack depth is only measured
+         *       if a maximum depth has been set.
+         *
+         * @param skipped Number of calls of the logger which are expected
+         *        by `strip_calls` between the caller and here, but missing
+         *        (1 from `CLUTCHLOGD`, which does not go through `log`).
+         */
+        scope_t locate(site_t& site, const bool with_depth = true, const size_t skipped = 0) const
+        {
+            scope_t scope; // False scope by default.
+            scope.stage = site.stage;
+
+            /***** Forced state *****/
+            const switching state = site.state();
+            if(state == switching::disabled) {
+                return scope;
+            } else if(state == switching::enabled) {
+                // Neither the thresholds nor the filters apply.
+                scope.there = true;
+                scope.forced = true;
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                // Measure the depth, only for its display.
+                within_depth(scope, with_depth, skipped);
+#endif
+                scope.matches = true;
+                return scope;
+            }
+
+            /***** Log level stage *****/
+            if(not (scope.stage <= _widest.load(std::memory_order_relaxed))) {
+                return scope;
+            }
+
+            /***** Location *****/
+            // Cached, hence faster than the stack depth.
+            const location_t* loc = _location.load(std::memory_order_acquire);
+            size_t verdict = site.verdict.load(std::memory_order_relaxed);
+            if(verdict >> 1 != loc->generation) {
+                verdict = loc->generation << 1 | is_there(*loc, site.file, site.func, site.line);
+                site.verdict.store(verdict, std::memory_order_relaxed);
+            }
+            scope.there = verdict & 1;
+            if(not scope.there) {
+                return scope;
+            }
+
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            /***** Stack depth *****/
+            if(not within_depth(scope, with_depth, skipped)) {
+                return scope;
+            }
+#endif
+            scope.matches = true;
+
+            return scope;
+        } // locate
+
+        //! Returns true if the given location matches the given location filters.
+        static bool is_there(const location_t& loc, const char* file, const char* func, const size_t line)
+        {
+            return std::regex_search(file, loc.file)
+               and std::regex_search(func, loc.func)
+               and std::regex_search(std::to_string(line), loc.line);
+        }
+
+        /** Replace `mark` by `tag` in `form`.
+         *
+         * @code
+         * log.replace("{greet} {world}", "\\{greet\\}", "hello");
+         * // returns "hello {world}"
+         * @endcode
+         */
+        std::string replace(
+                const std::string& form,
+                const std::string& mark,
+                const std::string& tag
+            ) const
+        {
+            // Useless debug code, unless something fancy would be done with name tags.
+            // std::regex re;
+            // try {
+            //     re = std::regex(mark);
+            //
+            // } catch(const std::regex_error& e) {
+            //     std::cerr << "ERROR with a regular expression \"" << mark << "\": ";
+            //     switch(e.code()) {
+            //         case std::regex_constants::error_collate:
+            //             std::cerr << "the expression contains an invalid collating element name";
+            //             break;
+            //         case std::regex_constants::error_ctype:
+            //             std::cerr << "the expression contains an invalid character class name";
+            //             break;
+            //         case std::regex_constants::error_escape:
+            //             std::cerr << "the expression contains an invalid escaped character or a trailing escape";
+            //             break;
+            //         case std::regex_constants::error_backref:
+            //             std::cerr << "the expression contains an invalid back reference";
+            //             break;
+            //         case std::regex_constants::error_brack:
+            //             std::cerr << "the expression contains mismatched square brackets ('[' and ']')";
+            //             break;
+            //         case std::regex_constants::error_paren:
+            //             std::cerr << "the expression contains mismatched parentheses ('(' and ')')";
+            //             break;
+            //         case std::regex_constants::error_brace:
+            //             std::cerr << "the expression contains mismatched curly braces ('{' and '}')";
+            //             break;
+            //         case std::regex_constants::error_badbrace:
+            //             std::cerr << "the expression contains an invalid range in a {} expression";
+            //             break;
+            //         case std::regex_constants::error_range:
+            //             std::cerr << "the expression contains an invalid character range (e.g. [b-a])";
+            //             break;
+            //         case std::regex_constants::error_space:
+            //             std::cerr << "there was not enough memory to convert the expression into a finite state machine";
+            //             break;
+            //         case std::regex_constants::error_badrepeat:
+            //             std::cerr << "one of *?+{ was not preceded by a valid regular expression";
+            //             break;
+            //         case std::regex_constants::error_complexity:
+            //             std::cerr << "the complexity of an attempted match exceeded a predefined level";
+            //             break;
+            //         case std::regex_constants::error_stack:
+            //             std::cerr << "there was not enough memory to perform a match";
+            //             break;
+            //         default:
+            //             std::cerr << "unknown error";
+            //     }
+            //     std::cerr << std::endl;
+            //     throw;
+            // } // catch
+
+            const std::regex re(mark);
+            return std::regex_replace(form, re, tag);
+        }
+
+        //! Replace `mark` by `tag` in `form`, converting tag to its string representation first.
+        std::string replace(
+                const std::string& form,
+                const std::string& mark,
+                const size_t tag
+            ) const
+        {
+            std::ostringstream stag; stag << tag;
+            return replace(form, mark, stag.str());
+        }
+
+        /** Number of displayed characters within the `[begin,end)` range of the given row.
+         *
+         * ANSI escape sequences are not counted, and UTF-8 characters count as one.
+         */
+        static size_t width(const std::string& row, const size_t begin, const size_t end)
+        {
+            return format_t::width(std::string_view(row).substr(begin, end - begin));
+        }
+
+        //! Substitute all tags in the format string with the corresponding information and apply the style corresponding to the log level.
+        std::string format(
+                std::string row,
+                const std::string& what,
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                const std::string& name,
+#endif
+                const level& stage,
+                const std::string& file,
+                const std::string& func,
+                const size_t line
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                ,
+                const size_t depth
+#endif
+            ) const
+        {
+            return format(format_t(row), what,
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                    name,
+#endif
+                    stage, file, func, line
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                    , depth
+#endif
+                );
+        }
+
+        //! Substitute all tags of the given parsed template with the corresponding information and apply the style corresponding to the log level.
+        std::string format(
+                const format_t& form,
+                const std::string& what,
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                const std::string& name,
+#endif
+                const level& stage,
+                const std::string& file,
+                const std::string& func,
+                const size_t line
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                ,
+                const size_t depth
+#endif
+            ) const
+        {
+            std::string row;
+            format_to(row, form, what,
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                    name,
+#endif
+                    stage, file, func, line
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                    , depth
+#endif
+                );
+            return row;
+        }
+
+        //! Append to `row` the given parsed template, with all tags substituted and the style corresponding to the log level applied.
+        void format_to(
+                std::string& row,
+                const format_t& form,
+                const std::string& what,
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                const std::string& name,
+#endif
+                const level& stage,
+                const std::string& file,
+                const std::string& func,
+                const size_t line
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+                ,
+                const size_t depth
+#endif
+            ) const
+        {
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            const fields_t fields{what, name, stage, file, func, line, actual_depth(depth)};
+#else
+            const fields_t fields{what, stage, file, func, line};
+#endif
+            format_fields(row, form, nullptr, fields);
+        }
+
+
+        //! Print a log message IF the location matches the given one.
+        void log(
+                const level& stage,
+                const std::string& what,
+                const std::string& file, const std::string& func, const size_t line,
+                const size_t depth_delta = 0
+            ) const
+        {
+            scope_t scope = locate(stage, file, func, line, log_depth());
+
+            if(scope.matches) {
+                emit(scope, what, file, func, line, depth_delta);
+            } // if scopes.matches
+        }
+
+        /** Print a log message IF the location matches the given one.
+         *
+         * The message is built by calling `write` on an output stream,
+         * which only happens if the location matches.
+         *
+         * @code
+         * log.log(clutchlog::level::info, [&](std::ostream& os){ os << "x = " << x; }, CLUTCHLOC);
+         * @endcode
+         */
+        template<class W,
+            std::enable_if_t<std::is_invocable_v<W, std::ostream&>, int> = 0>
+        void log(
+                const level& stage,
+                W write,
+                const std::string& file, const std::string& func, const size_t line,
+                const size_t depth_delta = 0
+            ) const
+        {
+            scope_t scope = locate(stage, file, func, line, log_depth());
+
+            if(scope.matches) {
+                std::ostringstream what;
+                write(what);
+                emit(scope, what.str(), file, func, line, depth_delta);
+            } // if scopes.matches
+        }
+
+        //! Print a log message IF the location of the given call site matches.
+        template<class W,
+            std::enable_if_t<std::is_invocable_v<W, std::ostream&>, int> = 0>
+        void log(
+                site_t& site,
+                W write,
+                const size_t depth_delta = 0
+            ) const
+        {
+            scope_t scope = locate(site, log_depth());
+
+            if(scope.matches) {
+                if(recording()) {
+                    recording_t recorded;
+                    write(recorded.recorder());
+                    log(scope, site, recorded, depth_delta);
+                } else {
+                    std::ostringstream what;
+                    write(what);
+                    log(scope, site, what.str(), depth_delta);
+                }
+            } // if scopes.matches
+        }
+
+        /** Captures the arguments of a message, instead of formatting them (see `encoding::records`).
+         *
+         * Used by the macros in place of an `std::ostringstream`.
+         * Arithmetic values and strings are stored as raw bytes, to be formatted by `decode`.
+         * Any other value, and any value following a manipulator which changes
+         * how it would be formatted, goes through the `std::ostream` base,
+         * and its text is stored as a string.
+         * Thus, anything written for an `std::ostream` works the same.
+         */
+        class recorder_t : public std::ostream {
+            protected:
+                /** Stream buffer keeping the text formatted by the `std::ostream` base. */
+                class buffer_t : public std::streambuf {
+                    public:
+                        /** Text formatted since the last stored argument. */
+                        std::string text;
+                    protected:
+                        std::streamsize xsputn(const char* str, std::streamsize n) override
+                        {
+                            text.append(str, n);
+                            return n;
+                        }
+
+                        int_type overflow(int_type c) override
+                        {
+                            if(not traits_type::eq_int_type(c, traits_type::eof())) {
+                                text += traits_type::to_char_type(c);
+                            }
+                            return traits_type::not_eof(c);
+                        }
+                };
+
+                /** Encoded arguments. */
+                std::string _args;
+                /** Stream buffer. */
+                buffer_t _buffer;
+
+                //! True if a value would be formatted with the default settings.
+                bool pristine() const
+                {
+                    return flags() == (std::ios_base::skipws | std::ios_base::dec)
+                           and width() == 0 and precision() == 6;
+                }
+
+                //! Store the text formatted so far, if any.
+                void take_text()
+                {
+                    if(not _buffer.text.empty()) {
+                        string(_buffer.text);
+                        _buffer.text.clear();
+                    }
+                }
+
+                //! Store an arithmetic value after its kind and size, or format it if the settings are not the default ones.
+                template<class V>
+                recorder_t& raw(const char kind, const V value)
+                {
+                    if(not pristine()) {
+                        static_cast<std::ostream&>(*this) << value;
+                        return *this;
+                    }
+                    take_text();
+                    _args += kind;
+                    _args += static_cast<char>(sizeof(V));
+                    _args.append(reinterpret_cast<const char*>(&value), sizeof(V));
+                    return *this;
+                }
+
+                //! Store a string, after its size.
+                void string(const std::string_view str)
+                {
+                    const uint32_t size = str.size();
+                    _args += 's';
+                    _args.append(reinterpret_cast<const char*>(&size), sizeof(size));
+                    _args.append(str);
+                }
+
+            public:
+                //! Constructor.
+                recorder_t() : std::ostream(nullptr) { rdbuf(&_buffer); }
+
+                //! Forget the previous message and the formatting settings.
+                void restart()
+                {
+                    _args.clear();
+                    _buffer.text.clear();
+                    clear();
+                    flags(std::ios_base::skipws | std::ios_base::dec);
+                    width(0);
+                    precision(6);
+                    fill(' ');
+                }
+
+                //! The encoded arguments, once the message is written.
+                std::string_view args()
+                {
+                    take_text();
+                    return _args;
+                }
+
+                /** @name Stored values
+                 *
+                 * The other insertions are the ones of `std::ostream`.
+                 * @{ */
+                using std::ostream::operator<<;
+                recorder_t& operator<<(const bool value) { return raw('b', value); }
+                recorder_t& operator<<(const char value) { return raw('c', value); } // Displayed as a character by streams.
+                recorder_t& operator<<(const signed char value) { return raw('c', value); }
+                recorder_t& operator<<(const unsigned char value) { return raw('c', value); }
+                recorder_t& operator<<(const short value) { return raw('i', value); }
+                recorder_t& operator<<(const unsigned short value) { return raw('u', value); }
+                recorder_t& operator<<(const int value) { return raw('i', value); }
+                recorder_t& operator<<(const unsigned int value) { return raw('u', value); }
+                recorder_t& operator<<(const long value) { return raw('i', value); }
+                recorder_t& operator<<(const unsigned long value) { return raw('u', value); }
+                recorder_t& operator<<(const long long value) { return raw('i', value); }
+                recorder_t& operator<<(const unsigned long long value) { return raw('u', value); }
+                recorder_t& operator<<(const float value) { return raw('f', value); }
+                recorder_t& operator<<(const double value) { return raw('f', value); }
+                recorder_t& operator<<(const long double value) { return raw('f', value); }
+
+                recorder_t& operator<<(const std::string_view str)
+                {
+                    if(width() != 0) {
+                        static_cast<std::ostream&>(*this) << str;
+                    } else {
+                        take_text();
+                        string(str);
+                    }
+                    return *this;
+                }
+                recorder_t& operator<<(const std::string& str) { return *this << std::string_view(str); }
+                recorder_t& operator<<(const char* str) { return *this << std::string_view(str); }
+
+                //! Apply a manipulator (e.g. `std::endl`).
+                recorder_t& operator<<(std::ostream& (*manip)(std::ostream&)) { manip(*this); return *this; }
+                //! Apply a formatting manipulator (e.g. `std::hex`), which applies to the following values.
+                recorder_t& operator<<(std::ios_base& (*manip)(std::ios_base&)) { manip(*this); return *this; }
+                /** @} */
+        }; // recorder_t
+
+        /** Lends the recorder of the current thread during its lifetime.
+         *
+         * The same recorder is reused across calls, unless the message itself
+         * logs something, in which case the nested message gets its own.
+         * It is given back even if the message throws.
+         */
+        class recording_t {
+            protected:
+                /** Recorder of a nested message. */
+                std::optional<recorder_t> _nested;
+                /** True if the reused recorder is lent. */
+                const bool _outer;
+                /** Lent recorder. */
+                recorder_t* _recorder;
+
+                //! Recorder reused by the current thread.
+                static recorder_t& reused() { static thread_local recorder_t r; return r; }
+                //! True while the reused recorder of the current thread is lent.
+                static bool& busy() { static thread_local bool b = false; return b; }
+
+            public:
+                //! Lend a recorder, ready for a new message.
+                recording_t() :
+                    _outer(not busy()),
+                    _recorder(_outer ? &reused() : &_nested.emplace())
+                {
+                    busy() = true;
+                    _recorder->restart();
+                }
+                //! Give the reused recorder back.
+                ~recording_t() { if(_outer) { busy() = false; } }
+                recording_t(const recording_t&) = delete;
+                recording_t& operator=(const recording_t&) = delete;
+
+                //! The lent recorder.
+                recorder_t& recorder() { return *_recorder; }
+        }; // recording_t
+
+        //! True if the messages are recorded by a `recorder_t` (see `encoding::records`).
+        bool recording() const
+        {
+            return _encoding.load(std::memory_order_relaxed) == encoding::records;
+        }
+
+        //! True if the stack depth of the messages is needed.
+        bool log_depth() const
+        {
+            const encoding mode = _encoding.load(std::memory_order_relaxed);
+            return _format_log.uses_depth() or mode == encoding::json or mode == encoding::logfmt;
+        }
+
+        /** Print the message of a call site, whose location has already been checked.
+         *
+         * Used by the macros, which only build the message if `locate` matches.
+         */
+        void log(
+                const scope_t& scope,
+                const site_t& site,
+                const std::string& what,
+                const size_t depth_delta = 0
+            ) const
+        {
+            emit(scope, what, site.file, site.func, site.line, depth_delta, &site);
+        }
+
+        //! Print the recorded message of a call site, whose location has already been checked (see `encoding::records`).
+        void log(
+                const scope_t& scope,
+                const site_t& site,
+                recording_t& recorded,
+                const size_t depth_delta = 0
+            ) const
+        {
+            const std::string_view args = recorded.recorder().args();
+            // Only the sinks need the text.
+            std::string what;
+            for(const sink_t* sink : *_sinks.load(std::memory_order_acquire)) {
+                if(scope.forced or scope.stage <= sink->stage.load(std::memory_order_relaxed)) {
+                    render_args(args, what);
+                    break;
+                }
+            }
+            emit(scope, what, site.file, site.func, site.line, depth_delta, &site, &args);
+        }
+
+        //! Dump a serializable container after a comment line with log information.
+        template<class In>
+        void dump(
+                const level& stage,
+                const In container_begin, const In container_end,
+                const std::string& file, const std::string& func, const size_t line,
+                const std::string& filename_template = "dump_{n}.dat",
+                const std::string sep = dump_default_sep
+            ) const
+        {
+            scope_t scope = locate(stage, file, func, line, _format_dump.uses_depth());
+
+            if(scope.matches) {
+                emit_dump(scope, container_begin, container_end,
+                    file, func, line, filename_template, sep);
+            } // if scopes.matches
+        }
+
+        //! Dump a serializable container IF the location of the given call site matches.
+        template<class In>
+        void dump(
+                site_t& site,
+                const In container_begin, const In container_end,
+                const std::string& filename_template = "dump_{n}.dat",
+                const std::string sep = dump_default_sep
+            ) const
+        {
+            scope_t scope = locate(site, _format_dump.uses_depth());
+
+            if(scope.matches) {
+                emit_dump(scope, container_begin, container_end,
+                    site.file, site.func, site.line, filename_template, sep, &site);
+            } // if scopes.matches
+        }
+
+        //! First word of the header line of binary dumps.
+        static constexpr std::string_view dump_magic = "clutchdump";
+        //! Version of the binary dump encoding.
+        static constexpr size_t dump_version = 1;
+        //! Alignment of the items in binary dumps, from the start of the file.
+        static constexpr size_t dump_alignment = 16;
+
+        /** Write a binary dump (see `dumping::binary`) as a text dump.
+         *
+         * The comment line and the items are written to `out`,
+         * each one followed by `sep`, as `dump` would have written them in text mode.
+         * Items of non-arithmetic types are written as hexadecimal bytes.
+         *
+         * The `binary` view typically comes from a memory-mapped file,
+         * see the `clutchdump` tool.
+         *
+         * Throws `std::invalid_argument` if `binary` is not a binary dump of this version and byte order.
+         */
+        static void undump(const std::string_view binary, std::ostream& out, const std::string& sep = dump_default_sep)
+        {
+            // Header line: magic version byte_order type count comment_size
+            const size_t eol = binary.find('\n');
+            if(eol == std::string_view::npos) {
+                throw std::invalid_argument("not a binary dump (no header line)");
+            }
+            std::istringstream header(std::string(binary.substr(0, eol)));
+            std::string magic, order, type;
+            size_t version = 0, count = 0, comment_size = 0;
+            header >> magic >> version >> order >> type >> count >> comment_size;
+            if(not header or magic != dump_magic or type.size() < 2) {
+                throw std::invalid_argument("not a binary dump (bad header line)");
+            }
+            if(version != dump_version) {
+                throw std::invalid_argument("unsupported binary dump version: " + std::to_string(version));
+            }
+            if(order != dump_byte_order()) {
+                throw std::invalid_argument("binary dump in foreign byte order: " + order);
+            }
+            const char kind = type[0];
+            const size_t size = std::stoul(type.substr(1));
+            const size_t begin = aligned(eol + 1 + comment_size);
+            if(size == 0 or binary.size() < begin or (binary.size() - begin) / size < count) {
+                throw std::invalid_argument("truncated binary dump");
+            }
+
+            if(comment_size > 0) {
+                out << binary.substr(eol + 1, comment_size) << sep;
+            }
+            const char* items = binary.data() + begin;
+            switch(kind) {
+                case 'b': undump_as<bool>(items, count, out, sep); return;
+                case 'c': undump_as<char>(items, count, out, sep); return;
+                case 'i':
+                    switch(size) {
+                        case 1: undump_as<int8_t >(items, count, out, sep); return;
+                        case 2: undump_as<int16_t>(items, count, out, sep); return;
+                        case 4: undump_as<int32_t>(items, count, out, sep); return;
+                        case 8: undump_as<int64_t>(items, count, out, sep); return;
+                    } break;
+                case 'u':
+                    switch(size) {
+                        case 1: undump_as<uint8_t >(items, count, out, sep); return;
+                        case 2: undump_as<uint16_t>(items, count, out, sep); return;
+                        case 4: undump_as<uint32_t>(items, count, out, sep); return;
+                        case 8: undump_as<uint64_t>(items, count, out, sep); return;
+                    } break;
+                case 'f':
+                    if(size == sizeof(float)) { undump_as<float>(items, count, out, sep); return; }
+                    if(size == sizeof(double)) { undump_as<double>(items, count, out, sep); return; }
+                    if(size == sizeof(long double)) { undump_as<long double>(items, count, out, sep); return; }
+                    break;
+                case 'x': {
+                    const std::ios_base::fmtflags flags = out.flags();
+                    const char fill = out.fill();
+                    out << std::hex << std::setfill('0');
+                    for(size_t i = 0; i < count; ++i) {
+                        for(size_t b = 0; b < size; ++b) {
+                            out << std::setw(2) << static_cast<unsigned>(static_cast<unsigned char>(items[i * size + b]));
+                        }
+                        out << sep;
+                    }
+                    out.flags(flags);
+                    out.fill(fill);
+                    return;
+                }
+            }
+            throw std::invalid_argument("unsupported binary dump item type: " + type);
+        }
+
+        //! First word of the header line of binary records.
+        static constexpr std::string_view records_magic = "clutchrecords";
+        //! Version of the binary records encoding.
+        static constexpr size_t records_version = 1;
+
+        /** Write binary records (see `encoding::records`) as formatted messages.
+         *
+         * Each message is formatted with the template of its call site, as it was when
+         * the call site was recorded (or with `form`, if it is not empty),
+         * using the current settings of this logger: level names, styles, filename rendering, etc.
+         * If `stamps` is true, each message is preceded by its time stamp (in seconds since the epoch)
+         * and the number of the thread which logged it.
+         *
+         * The `records` view typically comes from a memory-mapped file, see the `clutchlog-decode` tool.
+         * Several records outputs may follow each other (e.g. from successive runs appending to the same file).
+         *
+         * Throws `std::invalid_argument` if `records` are not binary records of this version and byte order.
+         */
+        void decode(const std::string_view records, std::ostream& out, const bool stamps = false, const std::string& form = "") const
+        {
+            //! A call site, as recorded.
+            struct recorded_site_t {
+                level stage;
+                size_t line;
+                std::string_view file;
+                std::string_view func;
+                format_t format;
+            };
+            // Call sites may be defined after their first records in asynchronous mode,
+            // hence they are all read in a first pass.
+            std::map<std::pair<size_t,uint32_t>,recorded_site_t> sites;
+            std::map<std::string_view,format_t> forms;
+            const format_t forced(form);
+            std::string what;
+            std::string row;
+            for(size_t pass = 0; pass < 2; ++pass) {
+                reader_t in{records, 0};
+                size_t output = 0; // Number of headers seen.
+                std::string name;
+                while(not in.done()) {
+                    if(records.substr(in.pos, records_magic.size()) == records_magic) {
+                        name = std::string(read_records_header(in));
+                        output++;
+                        continue;
+                    }
+                    if(output == 0) {
+                        throw std::invalid_argument("not binary records (no header line)");
+                    }
+                    const char kind = in.get<char>();
+                    if(kind == 'S') {
+                        const uint32_t id = in.get<uint32_t>();
+                        const level stage = in.get_level();
+                        const uint32_t line = in.get<uint32_t>();
+                        const std::string_view file = in.str();
+                        const std::string_view func = in.str();
+                        const std::string_view source = in.str();
+                        if(pass == 0) {
+                            sites.emplace(std::make_pair(output, id),
+                                recorded_site_t{stage, line, file, func, format_t(std::string(source))});
+                        }
+                    } else if(kind == 'R') {
+                        const uint32_t id = in.get<uint32_t>();
+                        const uint64_t time = in.get<uint64_t>();
+                        const uint32_t depth = in.get<uint32_t>();
+                        const uint32_t thread = in.get<uint32_t>();
+                        const std::string_view args = in.str();
+                        if(pass == 1) {
+                            const auto found = sites.find(std::make_pair(output, id));
+                            if(found == sites.end()) {
+                                throw std::invalid_argument("record of an undefined call site: " + std::to_string(id));
+                            }
+                            const recorded_site_t& site = found->second;
+                            what.clear();
+                            render_args(args, what);
+                            row.clear();
+                            render_record(row, form.empty() ? site.format : forced, what, name,
+                                site.stage, site.file, site.func, site.line, depth, stamps, time, thread);
+                            out << row;
+                        }
+                    } else if(kind == 'T') {
+                        const level stage = in.get_level();
+                        const uint32_t line = in.get<uint32_t>();
+                        const uint64_t time = in.get<uint64_t>();
+                        const uint32_t depth = in.get<uint32_t>();
+                        const uint32_t thread = in.get<uint32_t>();
+                        const std::string_view file = in.str();
+                        const std::string_view func = in.str();
+                        const std::string_view source = in.str();
+                        const std::string_view message = in.str();
+                        if(pass == 1) {
+                            auto found = forms.find(source);
+                            if(found == forms.end()) {
+                                found = forms.emplace(source, format_t(std::string(source))).first;
+                            }
+                            what.assign(message);
+                            row.clear();
+                            render_record(row, form.empty() ? found->second : forced, what, name,
+                                stage, file, func, line, depth, stamps, time, thread);
+                            out << row;
+                        }
+                    } else {
+                        throw std::invalid_argument("corrupted binary records (unknown frame at byte "
+                            + std::to_string(in.pos - 1) + ")");
+                    }
+                }
+            }
+        }
+
+        /** @} */
+
+    protected:
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+        //! Stack depth without the stripped calls.
+        size_t actual_depth(const size_t depth) const
+        {
+            if( _strip_calls < depth) {
+                return depth - _strip_calls;
+            } else {
+                return 0;
+            }
+        }
+#endif
+
+        //! Append to `row` the given template (using its compiled version, if any).
+        void format_fields(
+                std::string& row,
+                const format_t& form,
+                const compiled_t compiled,
+                const fields_t& fields
+            ) const
+        {
+            if(compiled) {
+                (this->*compiled)(row, fields);
+                return;
+            }
+            using tag = format_t::tag;
+
+            row.reserve(row.size() + form.source.size() + fields.what.size() + fields.file.size() + fields.func.size());
+            begin_row(row, fields);
+
+            layout_t layout;
+            const bool has_hfill = form.uses(tag::hfill);
+
+            for(const auto& token : form.tokens) {
+                if(token.type == tag::literal) {
+                    row.append(form.source, token.pos, token.len);
+                    layout.columns += token.width;
+                    continue;
+                }
+                // Only count the columns of what is displayed, and only if necessary.
+                const size_t before = row.size();
+                switch(token.type) {
+                    case tag::msg:          append_tag<tag::msg>(row, fields, layout); break;
+                    case tag::file:         append_tag<tag::file>(row, fields, layout); break;
+                    case tag::func:         append_tag<tag::func>(row, fields, layout); break;
+                    case tag::line:         append_tag<tag::line>(row, fields, layout); break;
+                    case tag::level:        append_tag<tag::level>(row, fields, layout); break;
+                    case tag::level_letter: append_tag<tag::level_letter>(row, fields, layout); break;
+                    case tag::level_short:  append_tag<tag::level_short>(row, fields, layout); break;
+                    case tag::name:         append_tag<tag::name>(row, fields, layout); break;
+                    case tag::depth:        append_tag<tag::depth>(row, fields, layout); break;
+                    case tag::depth_marks:  append_tag<tag::depth_marks>(row, fields, layout); break;
+                    case tag::depth_fmt:    append_tag<tag::depth_fmt>(row, fields, layout); break;
+                    case tag::level_fmt:    append_tag<tag::level_fmt>(row, fields, layout); break;
+                    case tag::filehash_fmt: append_tag<tag::filehash_fmt>(row, fields, layout); break;
+                    case tag::funchash_fmt: append_tag<tag::funchash_fmt>(row, fields, layout); break;
+                    case tag::hfill:        append_tag<tag::hfill>(row, fields, layout); break;
+                    default: break;
+                }
+                if(has_hfill and not format_t::is_style(token.type)) {
+                    layout.columns += width(row, before, row.size());
+                }
+            }
+
+            end_row(row, layout, fields);
+        }
+
+        /** Append to `row` the template given as a compile-time string.
+         *
+         * The template is parsed at compile time, and each of its tokens
+         * is appended in turn, without dispatching on their kind at run time.
+         */
+        template<const char* form, size_t ... I>
+        void format_compiled(std::string& row, const fields_t& fields, std::index_sequence<I...>) const
+        {
+            using compiled = format_t::compiled<form>;
+
+            row.reserve(row.size() + compiled::source.size() + fields.what.size() + fields.file.size() + fields.func.size());
+            begin_row(row, fields);
+            layout_t layout;
+
+            (append_token<form, I>(row, fields, layout), ...);
+
+            end_row(row, layout, fields);
+        }
+
+        //! Append to `row` the `I`th token of the template given as a compile-time string.
+        template<const char* form, size_t I>
+        void append_token(std::string& row, const fields_t& fields, layout_t& layout) const
+        {
+            constexpr format_t::token_t token = format_t::compiled<form>::tokens[I];
+            if constexpr(token.type == format_t::tag::literal) {
+                row.append(form + token.pos, token.len);
+                layout.columns += token.width;
+            } else if constexpr(format_t::compiled<form>::has_hfill() and not format_t::is_style(token.type)) {
+                const size_t before = row.size();
+                append_tag<token.type>(row, fields, layout);
+                layout.columns += width(row, before, row.size());
+            } else {
+                append_tag<token.type>(row, fields, layout);
+            }
+        }
+
+        //! Append to `row` the template given as a compile-time string.
+        template<const char* form>
+        void format_compiled(std::string& row, const fields_t& fields) const
+        {
+            format_compiled<form>(row, fields, std::make_index_sequence<format_t::compiled<form>::size>());
+        }
+
+        //! True if the row should hold ANSI escape sequences.
+        static bool styled(const fields_t& fields)
+        {
+            return not fields.sink or fields.sink->styled;
+        }
+
+        //! Start a row with the style of its log level.
+        void begin_row(std::string& row, const fields_t& fields) const
+        {
+            // The level style wraps the whole row.
+            if(styled(fields)) {
+                row += _level_fmt[fields.stage].escape();
+            }
+        }
+
+    public:
+        /** Part of the given file path which is displayed by the given rendering method.
+         *
+         * It is always a slice of the path itself (as given by `__FILE__`),
+         * so that it does not need any allocation and can be computed at compile time.
+         * Like `std::filesystem::path`, only slashes are taken as separators.
+         */
+        static constexpr std::string_view filename_of(const std::string_view file, const enum filename method)
+        {
+            constexpr size_t npos = std::string_view::npos;
+            const size_t slash = file.rfind('/');
+            const size_t base_begin = slash == npos ? 0 : slash + 1;
+            const std::string_view base = file.substr(base_begin);
+
+            // Without the last extension, but for hidden files and special names.
+            const size_t dot = base.rfind('.');
+            const std::string_view stem = (dot == npos or dot == 0 or (base.size() == 2 and base[0] == '.' and base[1] == '.')) ? base : base.substr(0, dot);
+
+            // The directory just above the file (if any), the root keeping its slash.
+            size_t dir_begin = base_begin;
+            size_t dir_end = base_begin;
+            if(slash != npos) {
+                dir_end = slash == 0 ? 1 : slash;
+                const size_t above = slash == 0 ? npos : file.rfind('/', slash - 1);
+                dir_begin = above == npos ? 0 : above + 1;
+            }
+
+            switch(method) {
+                case filename::base:
+                    return base;
+                case filename::dir:
+                    return file.substr(dir_begin, dir_end - dir_begin);
+                case filename::dirbase:
+                    return file.substr(dir_begin);
+                case filename::stem:
+                    return stem;
+                case filename::dirstem:
+                    return file.substr(dir_begin, base_begin + stem.size() - dir_begin);
+                case filename::path:
+                default:
+                    return file;
+            }
+        }
+
+    protected:
+        //! Append to `row` the style chosen among `domain` for the given hash value (see `fmt::hash`).
+        void append_hash(std::string& row, const size_t h, const std::vector<fmt>& domain) const
+        {
+            if(domain.empty()) {
+                row += fmt(static_cast<short>(h % 256)).escape();
             } else {
-                throw std::out_of_range("'" + name + "' is not a valid log level name");
+                // No copy of the formatter.
+                row += domain[h % domain.size()].escape();
             }
         }
 
-        //! Set the regular expression filtering the file location.
-        void file(std::string file) {_in_file = file;}
-        //! Set the regular expression filtering the function location.
-        void func(std::string func) {_in_func = func;}
-        //! Set the regular expression filtering the line location.
-        void line(std::string line) {_in_line = line;}
-
-        //! Set the regular expressions filtering the location.
-        void location(
-                const std::string& in_file,
-                const std::string& in_function=".*",
-                const std::string& in_line=".*"
-            )
+        //! Append to `row` the information corresponding to the given template tag.
+        template<format_t::tag T>
+        void append_tag(std::string& row, const fields_t& fields, layout_t& layout) const
         {
-            file(in_file);
-            func(in_function);
-            line(in_line);
-        }
+            using tag = format_t::tag;
 
-        /** Set the style (color and typo) of the given log level.
-         *
-         * This version accept style arguments as if they were passed to `clutchlog::fmt`.
-         */
-        template<class ... FMT>
-        void style(level stage, FMT... styles) { this->style(stage,fmt(styles...)); }
-        //! Set the style (color and typo) of the given log level, passing a `fmt` instance.
-        void style(level stage, fmt style) { _level_fmt.at(stage) = style; }
-        //! Get the configured fmt instance of the given log level.
-        fmt  style(level stage) const { return _level_fmt.at(stage); }
+            if constexpr(T == tag::msg) {
+                row += fields.what;
 
-        //! Sets the file naming scheme. */
-        void filename(filename f) {_filename = f;}
+            } else if constexpr(T == tag::file) {
+                if(fields.site) {
+                    row += fields.site->filenames[_filename];
+                } else {
+                    row += filename_of(fields.file, _filename);
+                }
 
-        /** @} Configuration accessors */
+            } else if constexpr(T == tag::func) {
+                row += fields.func;
 
-    public:
+            } else if constexpr(T == tag::line) {
+                row += std::to_string(fields.line);
 
-        /** @name Low-level API
-         * @{ */
+            } else if constexpr(T == tag::level) {
+                row += _level_word[fields.stage];
+
+            } else if constexpr(T == tag::level_letter) {
+                row += _level_letter[fields.stage];
+
+            } else if constexpr(T == tag::level_short) {
+                row += _level_short[fields.stage];
 
-        //! Structure holding a location matching.
-        struct scope_t {
-            /** Everything is compatible. */
-            bool matches;
-            /** Current log level. */
-            level stage;
 #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-            /** Current depth. */
-            size_t depth;
+            } else if constexpr(T == tag::name) {
+                row += fields.name;
+
+            } else if constexpr(T == tag::depth) {
+                row += std::to_string(fields.depth);
+
+            } else if constexpr(T == tag::depth_fmt) {
+                if(not styled(fields)) {
+                    return;
+                } else if(_depth_fmts.size() == 0) {
+                    row += fmt(static_cast<short>(fields.depth % 256)).escape();
+                } else {
+                    row += _depth_fmts[std::min(fields.depth,_depth_fmts.size()-1)].escape();
+                }
+
+            } else if constexpr(T == tag::depth_marks) {
+                if(_depth_fmts.size() == 0 or not styled(fields)) {
+                    for(size_t i = 0; i < fields.depth; ++i) {
+                        row += _depth_mark;
+                    }
+                } else {
+                    for(size_t i = 0; i < fields.depth; ++i) {
+                        row += _depth_fmts[std::min(i+1,_depth_fmts.size()-1)].escape();
+                        row += _depth_mark;
+                    }
+                }
 #endif
-            /** Location is compatible. */
-            bool there;
-            /** Constructor. */
-            scope_t() :
-                matches(false),
-                stage(level::xdebug),
-#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-                depth(0),
+            } else if constexpr(T == tag::level_fmt) {
+                if(styled(fields)) {
+                    row += _level_fmt[fields.stage].escape();
+                }
+
+            } else if constexpr(T == tag::filehash_fmt) {
+                if(not styled(fields)) { return; }
+                append_hash(row,
+                    fields.site ? fields.site->filehash : std::hash<std::string_view>{}(fields.file),
+                    _filehash_fmts);
+
+            } else if constexpr(T == tag::funchash_fmt) {
+                if(not styled(fields)) { return; }
+                append_hash(row,
+                    fields.site ? fields.site->funchash : std::hash<std::string_view>{}(fields.func),
+                    _funchash_fmts);
+
+            } else if constexpr(T == tag::hfill) {
+                layout.hfills.emplace_back(row.size(), layout.columns);
+            }
+            // Other tags (e.g. system-dependent ones) are not displayed.
+        }
+
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+        //! SIGWINCH handler: async-signal-safe, only raises a flag and chains to the previous handler.
+        static void on_resize(int sig, siginfo_t* info, void* context)
+        {
+            _resized = true;
+            if(_previous_winch.sa_flags & SA_SIGINFO) {
+                if(_previous_winch.sa_sigaction) {
+                    _previous_winch.sa_sigaction(sig, info, context);
+                }
+            } else if(_previous_winch.sa_handler != SIG_DFL
+                  and _previous_winch.sa_handler != SIG_IGN) {
+                _previous_winch.sa_handler(sig);
+            }
+        }
+
+        //! File descriptor behind the given stream, or -1 if it is not known.
+        static int fileno_of(const std::ostream* out)
+        {
+            if(out == &std::cout) {
+                return STDOUT_FILENO;
+            } else if(out == &std::cerr or out == &std::clog) {
+                return STDERR_FILENO;
+            }
+            return -1;
+        }
+
+        //! File descriptor behind the output stream, or -1 if it is not known.
+        int out_fileno() const
+        {
+            const int fd = _out_fd.load();
+            return fd >= 0 ? fd : fileno_of(_out.load());
+        }
+
+        /** Width of the terminal behind the output stream (or the given sink), or zero if it is not a terminal.
+         *
+         * The width is cached, and only looked for again after the stream changed
+         * or the terminal was resized.
+         */
+        size_t columns(const sink_t* sink = nullptr) const
+        {
+            if(_resized.exchange(false)) {
+                _columns_stale = true;
+                for(sink_t* other : *_sinks.load(std::memory_order_acquire)) {
+                    other->columns_stale = true;
+                }
+            }
+            std::atomic<bool>& stale = sink ? sink->columns_stale : _columns_stale;
+            std::atomic<size_t>& cached = sink ? sink->nb_columns : _nb_columns;
+            if(stale.exchange(false)) {
+                size_t nb_columns = 0;
+                const int fd = sink ? fileno_of(sink->out) : out_fileno();
+                struct winsize w;
+                if(fd >= 0 and isatty(fd) and ioctl(fd, TIOCGWINSZ, &w) == 0) {
+                    nb_columns = w.ws_col;
+                }
+                cached = nb_columns;
+            }
+            return cached;
+        }
 #endif
-                there(false)
-            {}
-        }; // scope_t
 
+        //! Insert the hfills in the row and reset the style.
+        void end_row(std::string& row, const layout_t& layout, const fields_t& fields) const
+        {
+            const bool with_styles = styled(fields);
+            const auto& hfills = layout.hfills;
+            if(not hfills.empty()) {
+                // hfill is inserted last to allow for correct line width estimation.
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+                // Any other hfill tag is accounted as if it was still in the row.
+                const size_t hfill_tag_size = std::char_traits<char>::length("{hfill}");
+                const size_t nb_columns = std::max(std::min(columns(fields.sink), _hfill_max), _hfill_min);
+                // If we don't know the terminal width, only one filling character is inserted.
+                size_t nb_hfill = 1;
+                bool new_row = false;
+                if(nb_columns > 0) {
+                    const size_t  left_len = hfills.front().second;
+                    const size_t right_len = layout.columns - left_len
+                                           + (hfills.size()-1) * hfill_tag_size;
+                    if(right_len+left_len > nb_columns) {
+                        // The right part would go over the terminal width: add a new row.
+                        new_row = true;
+                        if(right_len < nb_columns) {
+                            // There is room for the right part on a new line.
+                            nb_hfill = nb_columns - right_len;
+                        }
+                        // Else, the right part still goes over columns: let it go.
+                    } else {
+                        // There is some space in between left and right parts.
+                        nb_hfill = nb_columns - (right_len+left_len);
+                    }
+                }
+#else
+                // We cannot know the terminal width.
+                const size_t nb_hfill = 1;
+                const bool new_row = false;
+#endif
+                std::string hfill_styled;
+                hfill_styled.reserve(1 + fmt::escape_capacity + nb_hfill + fmt::reset_escape.size());
+                if(new_row) {
+                    hfill_styled += '\n';
+                }
+                if(with_styles) {
+                    hfill_styled += _hfill_fmt.escape();
+                }
+                hfill_styled.append(nb_hfill, _hfill_char);
+                if(with_styles) {
+                    hfill_styled += fmt::reset_escape;
+                }
+                // Insert from the end, so that the previous positions stay valid.
+                for(auto ih = hfills.rbegin(); ih != hfills.rend(); ++ih) {
+                    row.insert(ih->first, hfill_styled);
+                }
+            }
 
-        //! Gather information on the current location of the call.
-        scope_t locate(
-                const level& stage,
-                const std::string& file,
-                const std::string& func,
-                const size_t line
+            if(with_styles) {
+                row += fmt::reset_escape;
+            }
+        }
+
+        //! Format and print a log message whose location has already been matched.
+        void emit(
+                const scope_t& scope,
+                const std::string& what,
+                const std::string_view file, const std::string_view func, const size_t line,
+                const size_t depth_delta,
+                const site_t* site = nullptr,
+                const std::string_view* args = nullptr
             ) const
         {
-            scope_t scope; // False scope by default.
+            // Reused across calls, to avoid allocating each time.
+            static thread_local std::string row;
+            row.clear();
+            const encoding mode = _encoding.load(std::memory_order_relaxed);
+            const bool recording = mode == encoding::records;
+            const bool structured = mode == encoding::json or mode == encoding::logfmt;
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            const fields_t fields{what, structured ? name() : name_for(_format_log),
+                            scope.stage, file, func,
+                            line, actual_depth(scope.depth + depth_delta), site};
+#else
+            const fields_t fields{what,
+                            scope.stage, file, func,
+                            line, site};
+#endif
+            const bool to_out = scope.forced or scope.stage <= _stage.load(std::memory_order_relaxed);
+            if(to_out) {
+                if(mode == encoding::formatted) {
+                    format_fields(row, _format_log, _format_log_compiled, fields);
+                } else if(structured) {
+                    encode_fields(row, fields, mode == encoding::json);
+                } else {
+                    encode_record(row, fields, args);
+                }
+            }
 
-            /***** Log level stage *****/
-            // Test stage first, because it's fastest.
-            scope.stage = stage;
-            if(not (scope.stage <= _stage)) {
-                // Bypass useless computations if no match
-                // because of the stage.
-                return scope;
+            // Rows of the sinks, each one pointing to an identical row if possible.
+            const sinks_t& sinks = *_sinks.load(std::memory_order_acquire);
+            static thread_local std::vector<std::string> rows;
+            static thread_local std::vector<const std::string*> made;
+            if(rows.size() < sinks.size()) {
+                rows.resize(sinks.size());
             }
-#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-            /***** Stack depth *****/
-            // Backtrace in second, quite fast.
-            size_t stack_depth;
-            void *buffer[_max_buffer];
-            stack_depth = backtrace(buffer, _max_buffer);
-            scope.depth = stack_depth;
-            if(not (scope.depth <= _depth + _strip_calls)) {
-                // Bypass if no match.
-                return scope;
+            made.assign(sinks.size(), nullptr);
+            for(size_t i = 0; i < sinks.size(); ++i) {
+                const sink_t& sink = *sinks[i];
+                if(not (scope.forced or scope.stage <= sink.stage.load(std::memory_order_relaxed))) {
+                    continue;
+                }
+                // The width of the hfills depends on the stream.
+                if(not sink.format.uses(format_t::tag::hfill)) {
+                    if(to_out and mode == encoding::formatted and sink.styled and sink.format.source == _format_log.source) {
+                        made[i] = &row;
+                        continue;
+                    }
+                    for(size_t j = 0; j < i and not made[i]; ++j) {
+                        if(made[j] and sinks[j]->styled == sink.styled and sinks[j]->format.source == sink.format.source) {
+                            made[i] = made[j];
+                        }
+                    }
+                    if(made[i]) { continue; }
+                }
+                fields_t sunk = fields;
+                sunk.sink = &sink;
+                rows[i].clear();
+                format_fields(rows[i], sink.format, nullptr, sunk);
+                made[i] = &rows[i];
             }
-#endif
 
-            /***** Location *****/
-            // Location last, slowest.
-            std::ostringstream sline; sline << line;
-            scope.there =
-                       std::regex_search(file, _in_file)
-                   and std::regex_search(func, _in_func)
-                   and std::regex_search(sline.str(), _in_line);
+            if(_async) {
+                if(to_out) {
+                    if(recording) {
+                        if(_records_due.load(std::memory_order_acquire)) {
+                            // The header goes before any record.
+                            std::lock_guard<std::mutex> lock(_records_mutex);
+                            if(_records_due.load(std::memory_order_acquire)) {
+                                std::string header;
+                                encode_records_header(header);
+                                _async->push(_out.load(), nullptr, _out_fd.load(), std::move(header));
+                                _records_due.store(false, std::memory_order_release);
+                            }
+                        }
+                        define_site(row, args ? site : nullptr);
+                    }
+                    _async->push(_out.load(), nullptr, _out_fd.load(), std::string(row));
+                }
+                for(size_t i = 0; i < sinks.size(); ++i) {
+                    if(made[i]) {
+                        _async->push(sinks[i]->out, sinks[i], -1, std::string(*made[i]));
+                    }
+                }
+                if(scope.stage == level::critical) {
+                    _async->drain();
+                }
+            } else {
+                // A whole line at once, so that lines from several threads do not interleave.
+                std::lock_guard<std::mutex> lock(_out_mutex);
+                if(to_out) {
+                    if(recording) {
+                        define_site(row, args ? site : nullptr);
+                        if(_records_due.exchange(false)) {
+                            std::string header;
+                            encode_records_header(header);
+                            row.insert(0, header);
+                        }
+                    }
+                    const int fd = _out_fd.load();
+                    _unflushed++;
+                    if(fd >= 0) {
+                        if(flush_due(scope.stage, _unflushed, _last_flush)
+                           or _fd_pending.size() + row.size() > _fd_buffer) {
+                            // The waiting messages and this one, in a single system call.
+                            const std::string_view pieces[] = {_fd_pending, row};
+                            write_fd(fd, pieces, 2);
+                            _fd_pending.clear();
+                            _unflushed = 0;
+                            _last_flush = std::chrono::steady_clock::now();
+                        } else {
+                            _fd_pending += row;
+                        }
+                    } else {
+                        _out.load()->write(row.data(), row.size());
+                        if(flush_due(scope.stage, _unflushed, _last_flush)) {
+                            flush_out();
+                        }
+                    }
+                }
+                for(size_t i = 0; i < sinks.size(); ++i) {
+                    sink_t& sink = *sinks[i];
+                    if(made[i] and not sink.removed) {
+                        sink.out->write(made[i]->data(), made[i]->size());
+                        sink.unflushed++;
+                        if(flush_due(scope.stage, sink.unflushed, sink.last_flush)) {
+                            flush_to(*sink.out, sink.unflushed, sink.last_flush);
+                        }
+                    }
+                }
+            }
+        }
 
-            // No need to retest stage and depth, which are true here.
-            scope.matches = scope.there;
+        //! Returns true if a stream should be flushed after a message of the given level (to be called under `_out_mutex`).
+        bool flush_due(const level stage, const size_t unflushed, const std::chrono::steady_clock::time_point last_flush) const
+        {
+            switch(_flushing) {
+                case flushing::on_level:
+                    return stage <= _flush_level;
+                case flushing::every_n:
+                    return unflushed >= _flush_n;
+                case flushing::every_ms:
+                    return std::chrono::steady_clock::now() - last_flush >= _flush_ms;
+                case flushing::manual:
+                    return false;
+                case flushing::always:
+                default:
+                    return true;
+            }
+        }
 
-            return scope;
-        } // locate
+        //! Flush the output stream, or write the messages waiting for the file descriptor (to be called under `_out_mutex`).
+        void flush_out() const
+        {
+            const int fd = _out_fd.load();
+            if(fd >= 0) {
+                const std::string_view pending = _fd_pending;
+                write_fd(fd, &pending, 1);
+                _fd_pending.clear();
+                _unflushed = 0;
+                _last_flush = std::chrono::steady_clock::now();
+            } else {
+                flush_to(*_out.load(), _unflushed, _last_flush);
+            }
+        }
 
-        /** Replace `mark` by `tag` in `form`.
+        /** Write all the given pieces on the file descriptor, with as few system calls as possible.
          *
-         * @code
-         * log.replace("{greet} {world}", "\\{greet\\}", "hello");
-         * // returns "hello {world}"
-         * @endcode
+         * Partial writes are resumed and interrupted calls are retried.
+         * On any other error, the remaining pieces are lost (as with a failed stream).
          */
-        std::string replace(
-                const std::string& form,
-                const std::string& mark,
-                const std::string& tag
-            ) const
+        static void write_fd(const int fd, const std::string_view* pieces, size_t count)
         {
-            // Useless debug code, unless something fancy would be done with name tags.
-            // std::regex re;
-            // try {
-            //     re = std::regex(mark);
-            //
-            // } catch(const std::regex_error& e) {
-            //     std::cerr << "ERROR with a regular expression \"" << mark << "\": ";
-            //     switch(e.code()) {
-            //         case std::regex_constants::error_collate:
-            //             std::cerr << "the expression contains an invalid collating element name";
-            //             break;
-            //         case std::regex_constants::error_ctype:
-            //             std::cerr << "the expression contains an invalid character class name";
-            //             break;
-            //         case std::regex_constants::error_escape:
-            //             std::cerr << "the expression contains an invalid escaped character or a trailing escape";
-            //             break;
-            //         case std::regex_constants::error_backref:
-            //             std::cerr << "the expression contains an invalid back reference";
-            //             break;
-            //         case std::regex_constants::error_brack:
-            //             std::cerr << "the expression contains mismatched square brackets ('[' and ']')";
-            //             break;
-            //         case std::regex_constants::error_paren:
-            //             std::cerr << "the expression contains mismatched parentheses ('(' and ')')";
-            //             break;
-            //         case std::regex_constants::error_brace:
-            //             std::cerr << "the expression contains mismatched curly braces ('{' and '}')";
-            //             break;
-            //         case std::regex_constants::error_badbrace:
-            //             std::cerr << "the expression contains an invalid range in a {} expression";
-            //             break;
-            //         case std::regex_constants::error_range:
-            //             std::cerr << "the expression contains an invalid character range (e.g. [b-a])";
-            //             break;
-            //         case std::regex_constants::error_space:
-            //             std::cerr << "there was not enough memory to convert the expression into a finite state machine";
-            //             break;
-            //         case std::regex_constants::error_badrepeat:
-            //             std::cerr << "one of *?+{ was not preceded by a valid regular expression";
-            //             break;
-            //         case std::regex_constants::error_complexity:
-            //             std::cerr << "the complexity of an attempted match exceeded a predefined level";
-            //             break;
-            //         case std::regex_constants::error_stack:
-            //             std::cerr << "there was not enough memory to perform a match";
-            //             break;
-            //         default:
-            //             std::cerr << "unknown error";
-            //     }
-            //     std::cerr << std::endl;
-            //     throw;
-            // } // catch
-
-            const std::regex re(mark);
-            return std::regex_replace(form, re, tag);
+#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
+            constexpr size_t max_pieces = 64;
+            struct iovec iov[max_pieces];
+            while(count > 0) {
+                const size_t nb = std::min(count, max_pieces);
+                size_t left = 0;
+                for(size_t i = 0; i < nb; ++i) {
+                    iov[i].iov_base = const_cast<char*>(pieces[i].data());
+                    iov[i].iov_len = pieces[i].size();
+                    left += pieces[i].size();
+                }
+                struct iovec* first = iov;
+                int remaining = nb;
+                while(left > 0) {
+                    const ssize_t written = ::writev(fd, first, remaining);
+                    if(written < 0) {
+                        if(errno == EINTR) { continue; }
+                        return;
+                    }
+                    left -= written;
+                    // Skip the pieces fully written, and resume within the next one.
+                    size_t done = written;
+                    while(remaining > 0 and done >= first->iov_len) {
+                        done -= first->iov_len;
+                        ++first;
+                        --remaining;
+                    }
+                    if(remaining > 0) {
+                        first->iov_base = static_cast<char*>(first->iov_base) + done;
+                        first->iov_len -= done;
+                    }
+                }
+                pieces += nb;
+                count -= nb;
+            }
+#else
+            (void)fd; (void)pieces; (void)count;
+#endif
         }
 
-        //! Replace `mark` by `tag` in `form`, converting tag to its string representation first.
-        std::string replace(
-                const std::string& form,
-                const std::string& mark,
-                const size_t tag
-            ) const
+        //! Flush the given stream and reset its flushing state (to be called under `_out_mutex`).
+        void flush_to(std::ostream& out, size_t& unflushed, std::chrono::steady_clock::time_point& last_flush) const
         {
-            std::ostringstream stag; stag << tag;
-            return replace(form, mark, stag.str());
+            out.flush();
+            unflushed = 0;
+            if(_flushing == flushing::every_ms) {
+                last_flush = std::chrono::steady_clock::now();
+            }
         }
 
-        //! Substitute all tags in the format string with the corresponding information and apply the style corresponding to the log level.
-        std::string format(
-                std::string row,
-                const std::string& what,
+        /** Append a message as a JSON object, or as a logfmt line.
+         *
+         * Neither the template nor the styles are used.
+         * Everything is appended in place, without any allocation once `row` is large enough.
+         */
+        void encode_fields(std::string& row, const fields_t& fields, const bool as_json) const
+        {
+            const std::string_view file = fields.site ? fields.site->filenames[_filename] : filename_of(fields.file, _filename);
+
+            // The time stamp never needs to be quoted nor escaped.
+            row += as_json ? "{\"timestamp\":\"" : "timestamp=";
+            write_timestamp(row, std::chrono::system_clock::now());
+            if(as_json) { row += '"'; }
+            put_field(row, as_json, "level", _level_word[fields.stage]);
 #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-                const std::string& name,
+            put_field(row, as_json, "name", fields.name);
 #endif
-                const level& stage,
-                const std::string& file,
-                const std::string& func,
-                const size_t line
+            put_field(row, as_json, "file", file);
+            put_field(row, as_json, "func", fields.func);
+            put_field(row, as_json, "line", fields.line);
 #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-                ,
-                const size_t depth
+            put_field(row, as_json, "depth", fields.depth);
 #endif
-            ) const
+            put_field(row, as_json, "message", fields.what);
+            row += as_json ? "}\n" : "\n";
+        }
+
+        //! Append the key of a field, after the previous one.
+        static void put_key(std::string& row, const bool as_json, const std::string_view key)
+        {
+            if(as_json) {
+                row += ",\"";
+                row += key;
+                row += "\":";
+            } else {
+                row += ' ';
+                row += key;
+                row += '=';
+            }
+        }
+
+        /** Class of a character in the field values:
+         *
+         * - 0: written as is,
+         * - 1: written as is, but needs quotes in logfmt (space and `=`),
+         * - 2: escaped (quotes, backslashes and control characters).
+         */
+        static unsigned char char_class(const unsigned char c)
         {
-            row = replace(row, "\\{msg\\}", what);
+            static constexpr std::array<unsigned char,256> classes = [](){
+                std::array<unsigned char,256> table{};
+                for(size_t i = 0; i < table.size(); ++i) {
+                    if(i < 0x20 or i == '"' or i == '\\' or i == 0x7f) {
+                        table[i] = 2;
+                    } else if(i == ' ' or i == '=') {
+                        table[i] = 1;
+                    }
+                }
+                return table;
+            }();
+            return classes[c];
+        }
 
-            const std::filesystem::path filepath(file);
-            std::string filename;
-            std::filesystem::path::iterator ip = filepath.end();
-            std::advance(ip, -2);
-            switch(_filename) {
-                case filename::base:
-                    filename = filepath.filename().string();
-                    break;
-                case filename::dir:
-                    filename = ip->string();
-                    break;
-                case filename::dirbase:
-                    filename = (*ip / filepath.filename()).string();
-                    break;
-                case filename::stem:
-                    filename = filepath.stem().string();
-                    break;
-                case filename::dirstem:
-                    filename = (*ip / filepath.stem()).string();
-                    break;
-                case filename::path:
-                default:
-                    filename = file;
-                    break;
+        //! Append a string field, quoted and escaped (in logfmt, only if needed).
+        static void put_field(std::string& row, const bool as_json, const std::string_view key, const std::string_view value)
+        {
+            put_key(row, as_json, key);
+            bool quoted = as_json or value.empty();
+            for(size_t i = 0; i < value.size() and not quoted; ++i) {
+                quoted = char_class(value[i]) != 0;
+            }
+            if(not quoted) {
+                row += value;
+                return;
+            }
+            row += '"';
+            escape(row, value);
+            row += '"';
+        }
+
+        //! Append a numeric field.
+        static void put_field(std::string& row, const bool as_json, const std::string_view key, const size_t value)
+        {
+            put_key(row, as_json, key);
+            char digits[std::numeric_limits<size_t>::digits10 + 1];
+            const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            row.append(digits, end - digits);
+        }
+
+        //! Append a string with its quotes, backslashes and control characters escaped, as in JSON.
+        static void escape(std::string& row, const std::string_view value)
+        {
+            static constexpr char hex[] = "0123456789abcdef";
+            size_t plain = 0; // Start of the run of characters which need no escaping.
+            for(size_t i = 0; i < value.size(); ++i) {
+                const unsigned char c = value[i];
+                if(char_class(c) != 2) {
+                    continue;
+                }
+                row.append(value.data() + plain, i - plain);
+                plain = i + 1;
+                row += '\\';
+                switch(c) {
+                    case '"':  row += '"'; break;
+                    case '\\': row += '\\'; break;
+                    case '\n': row += 'n'; break;
+                    case '\r': row += 'r'; break;
+                    case '\t': row += 't'; break;
+                    case '\b': row += 'b'; break;
+                    case '\f': row += 'f'; break;
+                    default:
+                        row += "u00";
+                        row += hex[c >> 4];
+                        row += hex[c & 0xf];
+                }
+            }
+            row.append(value.data() + plain, value.size() - plain);
+        }
+
+        //! Size of the time stamps of `encode_fields`, e.g. `2024-01-31T23:59:59.123456Z`.
+        static constexpr size_t timestamp_size = 27;
+
+        /** Append the given time as an UTC time stamp, with microseconds (without any system call).
+         *
+         * The date and time down to the second are only computed when the second changes.
+         */
+        static void write_timestamp(std::string& row, const std::chrono::system_clock::time_point when)
+        {
+            const auto digits = [](char* at, int64_t value, const size_t n) {
+                for(size_t i = n; i > 0; --i) {
+                    at[i-1] = '0' + value % 10;
+                    value /= 10;
+                }
+            };
+            const int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(when.time_since_epoch()).count();
+            int64_t seconds = us / 1000000;
+            int64_t fraction = us % 1000000;
+            if(fraction < 0) {
+                fraction += 1000000;
+                seconds--;
+            }
+            // Per thread, so that no synchronization is needed.
+            static thread_local int64_t last_seconds = -1;
+            static thread_local char stamp[timestamp_size];
+            if(seconds != last_seconds) {
+                last_seconds = seconds;
+                int64_t days = seconds / 86400;
+                int64_t in_day = seconds % 86400;
+                if(in_day < 0) {
+                    in_day += 86400;
+                    days--;
+                }
+                // Civil date from the number of days since the epoch (see H. Hinnant's date algorithms).
+                days += 719468;
+                const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+                const int64_t doe = days - era * 146097;
+                const int64_t yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+                const int64_t doy = doe - (365*yoe + yoe/4 - yoe/100);
+                const int64_t mp = (5*doy + 2) / 153;
+                const int64_t day = doy - (153*mp + 2) / 5 + 1;
+                const int64_t month = mp < 10 ? mp + 3 : mp - 9;
+                const int64_t year = yoe + era * 400 + (month <= 2);
+
+                digits(stamp, year, 4);
+                stamp[4] = '-';
+                digits(stamp + 5, month, 2);
+                stamp[7] = '-';
+                digits(stamp + 8, day, 2);
+                stamp[10] = 'T';
+                digits(stamp + 11, in_day / 3600, 2);
+                stamp[13] = ':';
+                digits(stamp + 14, in_day / 60 % 60, 2);
+                stamp[16] = ':';
+                digits(stamp + 17, in_day % 60, 2);
+                stamp[19] = '.';
+                stamp[26] = 'Z';
             }
-            row = replace(row, "\\{file\\}", filename);
+            digits(stamp + 20, fraction, 6);
+            row.append(stamp, timestamp_size);
+        }
 
+        //! Start a new records output: the header and the call sites will be written again (to be called under `_out_mutex`).
+        void restart_records()
+        {
+            _records_generation++;
+            _records_due.store(true, std::memory_order_release);
+        }
 
-            row = replace(row, "\\{func\\}", func);
-            row = replace(row, "\\{line\\}", line);
+        //! Append a value to binary records.
+        template<class T>
+        static void put(std::string& bytes, const T value)
+        {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
 
-            row = replace(row, "\\{level\\}", _level_word.at(stage));
-            std::string letter(1, _level_word.at(stage).at(0)); // char -> string
-            row = replace(row, "\\{level_letter\\}", letter);
-            row = replace(row, "\\{level_short\\}", _level_short.at(stage));
+        //! Append a string to binary records, after its size.
+        static void put_str(std::string& bytes, const std::string_view str)
+        {
+            put<uint32_t>(bytes, str.size());
+            bytes.append(str);
+        }
 
+        //! Append the header of binary records: magic version byte_order, then the program name.
+        void encode_records_header(std::string& bytes) const
+        {
+            bytes += records_magic;
+            bytes += ' ';
+            bytes += std::to_string(records_version);
+            bytes += ' ';
+            bytes += dump_byte_order();
+            bytes += '\n';
 #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-            size_t actual_depth = 0;
-            if( _strip_calls < depth) {
-                actual_depth = depth - _strip_calls;
+            put_str(bytes, name());
+#else
+            put_str(bytes, "");
+#endif
+        }
+
+        //! Insert the definition of the call site before its record, if it is not defined on the current output yet.
+        void define_site(std::string& row, const site_t* site) const
+        {
+            const size_t generation = _records_generation.load();
+            if(site == nullptr or site->recorded.exchange(generation) == generation) {
+                return;
             }
-            row = replace(row, "\\{name\\}", name);
-            row = replace(row, "\\{depth\\}", actual_depth);
+            std::string definition;
+            definition += 'S';
+            put<uint32_t>(definition, site->id);
+            put<uint8_t>(definition, site->stage);
+            put<uint32_t>(definition, site->line);
+            put_str(definition, site->file);
+            put_str(definition, site->func);
+            put_str(definition, _format_log.source);
+            row.insert(0, definition);
+        }
 
-            if(_depth_fmts.size() == 0) {
-                row = replace(row, "\\{depth_fmt\\}", fmt(actual_depth % 256).str() );
+        //! Small number identifying the calling thread in binary records.
+        static uint32_t thread_number()
+        {
+            static std::atomic<uint32_t> next(0);
+            static thread_local const uint32_t number = next++;
+            return number;
+        }
+
+        /** Append the binary record of a message.
+         *
+         * If the raw arguments are given (and the call site is known), only them and the call site identifier are written,
+         * else the record holds the whole location and the formatted message.
+         */
+        void encode_record(std::string& row, const fields_t& fields, const std::string_view* args) const
+        {
+            const uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+            const uint32_t depth = fields.depth;
+#else
+            const uint32_t depth = 0;
+#endif
+            if(args and fields.site) {
+                row += 'R';
+                put<uint32_t>(row, fields.site->id);
+                put<uint64_t>(row, time);
+                put<uint32_t>(row, depth);
+                put<uint32_t>(row, thread_number());
+                put_str(row, *args);
+            } else {
+                row += 'T';
+                put<uint8_t>(row, fields.stage);
+                put<uint32_t>(row, fields.line);
+                put<uint64_t>(row, time);
+                put<uint32_t>(row, depth);
+                put<uint32_t>(row, thread_number());
+                put_str(row, fields.file);
+                put_str(row, fields.func);
+                put_str(row, _format_log.source);
+                put_str(row, fields.what);
+            }
+        }
 
-                std::ostringstream chevrons;
-                for(size_t i = 0; i < actual_depth; ++i) {
-                    chevrons << _depth_mark;
+        //! Sequential reading of binary records.
+        struct reader_t {
+            /** All the records. */
+            const std::string_view data;
+            /** Current position. */
+            size_t pos;
+
+            //! True if everything has been read.
+            bool done() const { return pos >= data.size(); }
+
+            //! Read a value.
+            template<class T>
+            T get()
+            {
+                if(data.size() - pos < sizeof(T)) {
+                    throw std::invalid_argument("truncated binary records");
                 }
-                row = replace(row, "\\{depth_marks\\}", chevrons.str());
+                T value;
+                std::memcpy(&value, data.data() + pos, sizeof(T));
+                pos += sizeof(T);
+                return value;
+            }
 
-            } else {
-                row = replace(row, "\\{depth_fmt\\}",
-                    _depth_fmts[std::min(actual_depth,_depth_fmts.size()-1)].str() );
+            //! Read a log level.
+            level get_level()
+            {
+                const uint8_t stage = get<uint8_t>();
+                if(stage >= nb_levels) {
+                    throw std::invalid_argument("corrupted binary records (bad log level)");
+                }
+                return static_cast<level>(stage);
+            }
 
-                std::ostringstream chevrons;
-                for(size_t i = 0; i < actual_depth; ++i) {
-                    chevrons << _depth_fmts[std::min(i+1,_depth_fmts.size()-1)].str()
-                             << _depth_mark;
+            //! Read a string, as a view on the records.
+            std::string_view str()
+            {
+                const uint32_t size = get<uint32_t>();
+                if(data.size() - pos < size) {
+                    throw std::invalid_argument("truncated binary records");
                 }
-                row = replace(row, "\\{depth_marks\\}", chevrons.str());
+                const std::string_view value = data.substr(pos, size);
+                pos += size;
+                return value;
             }
-#endif
+        };
 
-            row = replace(row, "\\{level_fmt\\}", _level_fmt.at(stage).str());
-            row = replace(row, "\\{filehash_fmt\\}", fmt::hash(file, _filehash_fmts).str() );
-            row = replace(row, "\\{funchash_fmt\\}", fmt::hash(func, _funchash_fmts).str() );
+        //! Check the header of binary records and return the program name it holds.
+        static std::string_view read_records_header(reader_t& in)
+        {
+            const size_t eol = in.data.find('\n', in.pos);
+            if(eol == std::string_view::npos) {
+                throw std::invalid_argument("not binary records (no header line)");
+            }
+            std::istringstream header(std::string(in.data.substr(in.pos, eol - in.pos)));
+            std::string magic, order;
+            size_t version = 0;
+            header >> magic >> version >> order;
+            if(not header or magic != records_magic) {
+                throw std::invalid_argument("not binary records (bad header line)");
+            }
+            if(version != records_version) {
+                throw std::invalid_argument("unsupported binary records version: " + std::to_string(version));
+            }
+            if(order != dump_byte_order()) {
+                throw std::invalid_argument("binary records in foreign byte order: " + order);
+            }
+            in.pos = eol + 1;
+            return in.str();
+        }
 
-#if CLUTCHLOG_HAVE_UNIX_SYSIOCTL
-            // hfill is replaced last to allow for correct line width estimation.
-            const std::string raw_row = replace(row, "(\\x9B|\\x1B\\[)[0-?]*[ -\\/]*[@-~]", "");
-            const std::string hfill_tag = "{hfill}";
-            const size_t hfill_pos = row.find(hfill_tag);
-            const size_t raw_hfill_pos = raw_row.find(hfill_tag);
-            const size_t nb_columns = std::max(std::min((size_t)_nb_columns, _hfill_max), _hfill_min);
-            if(hfill_pos != std::string::npos) {
-                assert(raw_hfill_pos != std::string::npos);
-                if(nb_columns > 0) {
-                    const size_t  left_len = raw_hfill_pos;
-                    const size_t right_len = raw_row.size() - raw_hfill_pos - hfill_tag.size();
-                    if(right_len+left_len > nb_columns) {
-                        // The right part would go over the terminal width: add a new row.
-                        if(right_len < nb_columns) {
-                            // There is room for the right part on a new line.
-                            const std::string hfill(std::max((size_t)0, nb_columns-right_len), _hfill_char);
-                            const std::string hfill_styled = _hfill_fmt(hfill);
-                            row = replace(row, "\\{hfill\\}", "\n"+hfill_styled);
-                        } else {
-                            // Right part still goes over columns: let it go.
-                            const std::string hfill(1, _hfill_char);
-                            const std::string hfill_styled = _hfill_fmt(hfill);
-                            row = replace(row, "\\{hfill\\}", "\n"+hfill_styled);
-                        }
-                    } else {
-                        // There is some space in between left and right parts.
-                        const std::string hfill(std::max((size_t)0, nb_columns - (right_len+left_len)), _hfill_char);
-                        const std::string hfill_styled = _hfill_fmt(hfill);
-                        row = replace(row, "\\{hfill\\}", hfill_styled);
-                    }
-                } else {
-                    // We don't know the terminal width.
-                    const std::string hfill(1, _hfill_char);
-                    const std::string hfill_styled = _hfill_fmt(hfill);
-                    row = replace(row, "\\{hfill\\}", hfill_styled);
+        //! Append to `what` the text of the arguments stored by a `recorder_t`.
+        static void render_args(const std::string_view args, std::string& what)
+        {
+            // Floating point numbers are written as a default stream would.
+            static thread_local std::ostringstream number;
+            reader_t in{args, 0};
+            while(not in.done()) {
+                const char kind = in.get<char>();
+                if(kind == 's') {
+                    what += in.str();
+                    continue;
+                }
+                const uint8_t size = in.get<uint8_t>();
+                switch(kind) {
+                    case 'b': what += in.get<bool>() ? '1' : '0'; continue;
+                    case 'c': what += in.get<char>(); continue;
+                    case 'i':
+                        switch(size) {
+                            case 1: what += std::to_string(in.get<int8_t >()); continue;
+                            case 2: what += std::to_string(in.get<int16_t>()); continue;
+                            case 4: what += std::to_string(in.get<int32_t>()); continue;
+                            case 8: what += std::to_string(in.get<int64_t>()); continue;
+                        } break;
+                    case 'u':
+                        switch(size) {
+                            case 1: what += std::to_string(in.get<uint8_t >()); continue;
+                            case 2: what += std::to_string(in.get<uint16_t>()); continue;
+                            case 4: what += std::to_string(in.get<uint32_t>()); continue;
+                            case 8: what += std::to_string(in.get<uint64_t>()); continue;
+                        } break;
+                    case 'f':
+                        number.str("");
+                        if(size == sizeof(float)) { number << in.get<float>(); }
+                        else if(size == sizeof(double)) { number << in.get<double>(); }
+                        else if(size == sizeof(long double)) { number << in.get<long double>(); }
+                        else { break; }
+                        what += number.str();
+                        continue;
                 }
+                throw std::invalid_argument("corrupted binary records (bad argument type)");
             }
-#else
-            // We cannot know the terminal width.
-            const std::string hfill(1, _hfill_char);
-            const std::string hfill_styled = _hfill_fmt(hfill);
-            row = replace(row, "\\{hfill\\}", hfill_styled);
-#endif
-            return _level_fmt.at(stage)(row);
         }
 
-        //! Print a log message IF the location matches the given one.
-        void log(
-                const level& stage,
+        //! Append to `row` a decoded message, formatted with the given template.
+        void render_record(
+                std::string& row,
+                const format_t& form,
                 const std::string& what,
-                const std::string& file, const std::string& func, const size_t line,
-                const size_t depth_delta = 0
+                const std::string& name,
+                const level stage,
+                const std::string_view file, const std::string_view func, const size_t line,
+                const size_t depth,
+                const bool stamps, const uint64_t time, const uint32_t thread
             ) const
         {
-            scope_t scope = locate(stage, file, func, line);
-
-            if(scope.matches) {
+            if(stamps) {
+                char stamp[64];
+                std::snprintf(stamp, sizeof(stamp), "%llu.%09llu #%u ",
+                    static_cast<unsigned long long>(time / 1000000000),
+                    static_cast<unsigned long long>(time % 1000000000),
+                    static_cast<unsigned>(thread));
+                row += stamp;
+            }
 #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-                *_out << format(_format_log, what, basename(getenv("_")),
-                                stage, file, func,
-                                line, scope.depth + depth_delta );
+            const fields_t fields{what, name, stage, file, func, line, depth};
 #else
-                *_out << format(_format_log, what,
-                                stage, file, func,
-                                line );
+            (void)name; (void)depth;
+            const fields_t fields{what, stage, file, func, line};
 #endif
-                _out->flush();
-            } // if scopes.matches
+            format_fields(row, form, nullptr, fields);
         }
 
-        //! Dump a serializable container after a comment line with log information.
-        template<class In>
-        void dump(
-                const level& stage,
-                const In container_begin, const In container_end,
-                const std::string& file, const std::string& func, const size_t line,
-                const std::string& filename_template = "dump_{n}.dat",
-                const std::string sep = dump_default_sep
-            ) const
+        //! Publish a new list of sinks, made by applying `change` on a copy of the current one (to be called under `_sinks_mutex`).
+        template<class F>
+        void publish_sinks(F change)
         {
-            scope_t scope = locate(stage, file, func, line);
+            std::unique_ptr<sinks_t> sinks(new sinks_t(*_sinks.load()));
+            change(*sinks);
+            _sinks.store(sinks.get(), std::memory_order_release);
+            _sink_lists.push_back(std::move(sinks));
+        }
 
-            if(scope.matches) {
-                const std::string tag = "\\{n\\}";
-                const std::regex re(tag);
-                std::string outfile = "";
+        //! Update the widest log level among the output stream and the sinks.
+        void widen()
+        {
+            std::lock_guard<std::mutex> lock(_sinks_mutex);
+            level widest = _stage.load(std::memory_order_relaxed);
+            for(const sink_t* sink : *_sinks.load()) {
+                widest = std::max(widest, sink->stage.load(std::memory_order_relaxed));
+            }
+            _widest.store(widest, std::memory_order_relaxed);
+        }
 
-                // If the file name template has the {n} tag.
-                if(std::regex_search(filename_template, re)) {
-                    // Increment n until a free one is found.
-                    size_t n = 0;
-                    do {
-                        outfile = replace(filename_template, tag, n);
-                        n++;
-                    } while( fs::exists( outfile ) );
+        //! Add a call site to the registry, if it is not already, and return its state.
+        switching enroll(site_t& site)
+        {
+            std::lock_guard<std::mutex> lock(_sites_mutex);
+            const int s = site.switched.load(std::memory_order_acquire);
+            if(s >= 0) {
+                // Another thread has been faster.
+                return static_cast<switching>(s);
+            }
+            site.filehash = std::hash<std::string_view>{}(site.file);
+            site.funchash = std::hash<std::string_view>{}(site.func);
+            site.id = _sites.size();
+            _sites.push_back(&site);
+            site.switched.store(switching::follow, std::memory_order_release);
+            return switching::follow;
+        }
 
-                } else {
-                    // Use the parameter as is.
-                    outfile = filename_template;
+        //! Publish new location filters, made by applying `change` on a copy of the current ones.
+        template<class F>
+        void relocate(F change)
+        {
+            std::lock_guard<std::mutex> lock(_location_mutex);
+            std::unique_ptr<location_t> loc(new location_t(*_location.load()));
+            change(*loc);
+            loc->generation++;
+            _location.store(loc.get(), std::memory_order_release);
+            _locations.push_back(std::move(loc));
+        }
+
+        //! Tag of the dump file name templates, replaced by the dump number.
+        static constexpr std::string_view dump_tag = "{n}";
+
+        //! Replace all the `{n}` tags in `filename_template` by `n`.
+        static std::string numbered(const std::string& filename_template, const size_t n)
+        {
+            const std::string number = std::to_string(n);
+            std::string name = filename_template;
+            for(size_t at = name.find(dump_tag); at != std::string::npos; at = name.find(dump_tag, at + number.size())) {
+                name.replace(at, dump_tag.size(), number);
+            }
+            return name;
+        }
+
+        /** Largest number used by existing files named after `filename_template`, plus one (zero if none).
+         *
+         * Scans the directory of the template once,
+         * if the `{n}` tag is in the file name (and not in the directory).
+         */
+        static size_t first_free(const std::string& filename_template)
+        {
+            const fs::path path(filename_template);
+            const std::string name = path.filename().string();
+            const size_t at = name.find(dump_tag);
+            if(at == std::string::npos) {
+                return 0;
+            }
+            const fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+            std::error_code err;
+            fs::directory_iterator entries(dir, err);
+            size_t next = 0;
+            for(; not err and entries != fs::directory_iterator(); entries.increment(err)) {
+                const std::string entry = entries->path().filename().string();
+                if(entry.compare(0, at, name, 0, at) != 0) {
+                    continue;
+                }
+                const size_t digits = entry.find_first_not_of("0123456789", at);
+                if(digits == at) {
+                    continue;
+                }
+                const std::string number = entry.substr(at, digits == std::string::npos ? std::string::npos : digits - at);
+                if(number.size() > std::numeric_limits<size_t>::digits10) {
+                    continue;
+                }
+                const size_t n = std::stoul(number);
+                if(numbered(name, n) == entry) {
+                    next = std::max(next, n + 1);
                 }
+            }
+            return next;
+        }
 
-                std::ofstream fd(outfile);
+        /** Name of the file to dump in.
+         *
+         * If the template has the `{n}` tag,
+         * the file is created with a number that was not used by any existing file.
+         * The directory is scanned the first time a template is used,
+         * then the last issued number is remembered.
+         * Files are created exclusively, so that concurrent dumps never share a file,
+         * even across processes.
+         */
+        std::string dump_file(const std::string& filename_template) const
+        {
+            if(filename_template.find(dump_tag) == std::string::npos) {
+                // Use the parameter as is.
+                return filename_template;
+            }
+
+            std::lock_guard<std::mutex> lock(_dump_mutex);
+            auto next = _dump_next.find(filename_template);
+            if(next == _dump_next.end()) {
+                next = _dump_next.emplace(filename_template, first_free(filename_template)).first;
+            }
+            std::string outfile;
+            while(true) {
+                outfile = numbered(filename_template, next->second++);
+                // Exclusive creation ("x" mode), fails if the file exists.
+                std::FILE* created = std::fopen(outfile.c_str(), "wx");
+                if(created) {
+                    std::fclose(created);
+                    break;
+                }
+                if(errno != EEXIST) {
+                    break; // Let the caller fail on opening it.
+                }
+            }
+            return outfile;
+        }
+
+        //! True if the items in [`In`, `In`) are stored contiguously and can be dumped as raw bytes.
+        template<class In, class V = typename std::iterator_traits<In>::value_type>
+        static constexpr bool is_raw_dumpable_v = std::is_trivially_copyable_v<V> and (
+                std::is_pointer_v<In>
+                or (not std::is_same_v<V, bool> and (
+                       std::is_same_v<In, typename std::vector<V>::iterator>
+                    or std::is_same_v<In, typename std::vector<V>::const_iterator>)));
+
+        //! True if items of type `V` can be written with `operator<<`.
+        template<class V, class = void>
+        struct is_printable : std::false_type {};
+        //! True if items of type `V` can be written with `operator<<`.
+        template<class V>
+        struct is_printable<V,
+            std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const V&>())>> : std::true_type {};
+        //! True if items of type `V` can be written with `operator<<`.
+        template<class V>
+        static constexpr bool is_printable_v = is_printable<V>::value;
+
+        //! Code of an item type in binary dumps: a kind letter followed by the size in bytes.
+        template<class V>
+        static std::string dump_type()
+        {
+            std::string kind;
+            if constexpr(std::is_same_v<V, bool>) {
+                kind = "b";
+            } else if constexpr(std::is_same_v<V, char> or std::is_same_v<V, signed char> or std::is_same_v<V, unsigned char>) {
+                kind = "c"; // Written as characters by operator<<.
+            } else if constexpr(std::is_integral_v<V> and std::is_signed_v<V>) {
+                kind = "i";
+            } else if constexpr(std::is_integral_v<V>) {
+                kind = "u";
+            } else if constexpr(std::is_floating_point_v<V>) {
+                kind = "f";
+            } else {
+                kind = "x";
+            }
+            return kind + std::to_string(sizeof(V));
+        }
+
+        //! Byte order of this machine, as written in binary dumps.
+        static std::string dump_byte_order()
+        {
+            const uint16_t one = 1;
+            return *reinterpret_cast<const unsigned char*>(&one) == 1 ? "le" : "be";
+        }
+
+        //! Smallest multiple of `dump_alignment` not below `offset`.
+        static constexpr size_t aligned(const size_t offset)
+        {
+            return (offset + dump_alignment - 1) / dump_alignment * dump_alignment;
+        }
+
+        //! Write `count` items of type `V` stored at `items`, each one followed by `sep`.
+        template<class V>
+        static void undump_as(const char* items, const size_t count, std::ostream& out, const std::string& sep)
+        {
+            for(size_t i = 0; i < count; ++i) {
+                V item;
+                std::memcpy(&item, items + i * sizeof(V), sizeof(V));
+                out << item << sep;
+            }
+        }
+
+        //! Dump a serializable container whose location has already been matched.
+        template<class In>
+        void emit_dump(
+                const scope_t& scope,
+                const In container_begin, const In container_end,
+                const std::string_view file, const std::string_view func, const size_t line,
+                const std::string& filename_template,
+                const std::string& sep,
+                const site_t* site = nullptr
+            ) const
+        {
+            const std::string outfile = dump_file(filename_template);
 
-                if(_format_dump.size() > 0) {
+            std::string row;
+            if(_format_dump.source.size() > 0) {
+                const std::string what;
 #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
-                    fd << format(_format_dump, "", basename(getenv("_")),
-                            stage, file, func,
-                            line, scope.depth );
+                const fields_t fields{what, name_for(_format_dump),
+                        scope.stage, file, func,
+                        line, actual_depth(scope.depth), site};
 #else
-                    fd << format(_format_dump, "",
-                            stage, file, func,
-                            line );
+                const fields_t fields{what,
+                        scope.stage, file, func,
+                        line, site};
 #endif
+                format_fields(row, _format_dump, _format_dump_compiled, fields);
+            }
+
+            using V = typename std::iterator_traits<In>::value_type;
+            static_assert(is_raw_dumpable_v<In> or is_printable_v<V>,
+                "dumped items should either have an operator<< or be stored contiguously");
+
+            if constexpr(is_raw_dumpable_v<In>) {
+                // Items which cannot be written as text are always dumped as raw bytes.
+                if(_dumping == dumping::binary or not is_printable_v<V>) {
+                    const size_t count = std::distance(container_begin, container_end);
+                    std::ostringstream header;
+                    header << dump_magic << " " << dump_version << " " << dump_byte_order()
+                           << " " << dump_type<V>() << " " << count << " " << row.size() << "\n"
+                           << row;
+                    std::string head = header.str();
+                    head.resize(aligned(head.size()), '\0');
+
+                    // Large writes bypass the stream buffer: the items are not copied.
+                    std::ofstream fd(outfile, std::ios::binary);
+                    fd.write(head.data(), head.size());
+                    if(count > 0) {
+                        fd.write(reinterpret_cast<const char*>(&*container_begin), count * sizeof(V));
+                    }
+                    fd.close();
+                    return;
+                }
+            }
+
+            if constexpr(is_printable_v<V>) {
+                std::ofstream fd(outfile);
+                if(_format_dump.source.size() > 0) {
+                    fd << row;
                     fd << sep; // sep after comment line.
                 }
 
                 std::copy(container_begin, container_end,
-                    std::ostream_iterator<typename In::value_type>(fd, sep.c_str()));
+                    std::ostream_iterator<V>(fd, sep.c_str()));
 
                 fd.close();
-            } // if scopes.matches
+            }
         }
 
-        /** @} */
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+        //! The program name, or an empty string if the given template does not display it.
+        const std::string& name_for(const format_t& form) const
+        {
+            static const std::string none;
+            if(form.uses(format_t::tag::name)) {
+                return name();
+            } else {
+                return none;
+            }
+        }
+
+        /** Look for the name of the running program.
+         *
+         * Use the name given by the C library if possible,
+         * then the one given by the kernel (which may be truncated),
+         * then the one set by the shell (which may be absent).
+         */
+        static std::string process_name()
+        {
+#if defined(__GLIBC__) and defined(_GNU_SOURCE)
+            if(program_invocation_short_name and program_invocation_short_name[0] != '\0') {
+                return program_invocation_short_name;
+            }
+#endif
+            std::ifstream comm("/proc/self/comm");
+            std::string name;
+            if(std::getline(comm, name) and not name.empty()) {
+                return name;
+            }
+            const char* shell = getenv("_");
+            if(shell) {
+                std::string path(shell); // basename may modify its argument.
+                return basename(path.data());
+            }
+            return "";
+        }
+
+        /** Measure the stack depth into the given scope, and return true if it is not above the maximum depth.
+         *
+         * The depth is measured only if it is needed,
+         * either to be displayed (if `with_depth` is true),
+         * or because a maximum depth is set.
+         * In the latter case, the call stack is not walked further than the maximum depth.
+         *
+         * The `skipped` calls of the logger are counted as if they were on the stack.
+         *
+         * @note This is always inlined, so that it does not count as a call itself.
+         */
+        [[gnu::always_inline]] inline bool within_depth(scope_t& scope, const bool with_depth, const size_t skipped = 0) const
+        {
+            const size_t depth = _depth.load(std::memory_order_relaxed);
+#if CLUTCHLOG_DEPTH_SCOPE == 1
+            (void)with_depth; // Counting scopes costs nothing.
+            (void)skipped;
+            scope.depth = _scope_depth + _strip_calls;
+#else
+            const bool limited = depth < std::numeric_limits<size_t>::max() - _strip_calls;
+            if(not limited and not with_depth) {
+                return true;
+            }
+            size_t max_depth = _max_buffer;
+            if(not with_depth) {
+                // One more frame than allowed is enough to know if it is too deep.
+                const size_t wanted = depth + _strip_calls + 1;
+                max_depth = std::min(wanted > skipped ? wanted - skipped : 0, _max_buffer);
+            }
+            if(max_depth <= _stack_buffer) {
+                // Small enough for the stack (typically with a maximum depth).
+                void* buffer[_stack_buffer];
+                scope.depth = backtrace(buffer, max_depth);
+            } else {
+                // Allocated once per thread.
+                static thread_local std::vector<void*> buffer(_max_buffer);
+                scope.depth = backtrace(buffer.data(), max_depth);
+            }
+            scope.depth += skipped;
+#endif
+            return scope.depth <= depth + _strip_calls;
+        }
+#endif
 };
 
 /** @} */
@@ -1524,14 +5098,31 @@ class clutchlog
             return instance;
         }
         enum level {critical=0, error=1, warning=2, progress=3, note=4, info=5, debug=6, xdebug=7};
+        static constexpr size_t nb_levels = level::xdebug + 1;
         enum filename {path, base, dir, dirbase, stem, dirstem};
+        enum overflow {block, drop_newest, drop_oldest};
+        enum flushing {always, on_level, every_n, every_ms, manual};
+        enum switching {follow, enabled, disabled};
+        enum dumping {text, binary};
+        enum encoding {formatted, records, json, logfmt};
+        class rotating_file : public std::ostream {
+            public:
+                rotating_file(const std::string&, const size_t, const std::chrono::seconds = std::chrono::seconds(0), const size_t = 5, const bool = true) : std::ostream(nullptr) {}
+                void rotate() {}
+                size_t generation() const { return 0; }
+                void settle() {}
+        };
         class fmt {
             public:
-                enum class ansi { colors_16, colors_256,  colors_16M} mode;
-                enum class typo { reset, bold, underline, inverse, none} style;
-                enum class fg { black, red, green, yellow, blue, magenta, cyan, white, bright_black, bright_red, bright_green, bright_yellow, bright_blue, bright_magenta, bright_cyan, bright_white, none} fore;
-                enum class bg { black, red, green, yellow, blue, magenta, cyan, white, bright_black, bright_red, bright_green, bright_yellow, bright_blue, bright_magenta, bright_cyan, bright_white, none } back;
+                enum class ansi { colors_16, colors_256,  colors_16M};
+                enum class typo { reset, bold, underline, inverse, none};
+                enum class fg { black, red, green, yellow, blue, magenta, cyan, white, bright_black, bright_red, bright_green, bright_yellow, bright_blue, bright_magenta, bright_cyan, bright_white, none};
+                enum class bg { black, red, green, yellow, blue, magenta, cyan, white, bright_black, bright_red, bright_green, bright_yellow, bright_blue, bright_magenta, bright_cyan, bright_white, none };
             protected:
+                ansi _mode;
+                typo _style;
+                fg _fore;
+                bg _back;
                 friend std::ostream& operator<<(std::ostream&, const std::tuple<fg,bg,typo>&) {}
                 friend std::ostream& operator<<(std::ostream&, const typo&) {}
             protected:
@@ -1581,46 +5172,57 @@ class clutchlog
                     bg_16M(const bg&) : color_16M(ground::back, -1,-1,-1) {}
                 } back_16M;
             public:
-                fmt() : mode(ansi::colors_16), style(typo::none), fore(fg::none), back(bg::none) {}
-                fmt(  fg f,   bg b = bg::none, typo s = typo::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                fmt(  fg f, typo s           ,   bg b =   bg::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                fmt(  bg b,   fg f = fg::none, typo s = typo::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                fmt(  bg b, typo s           ,   fg f =   fg::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                fmt(typo s,   fg f = fg::none,   bg b =   bg::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                fmt(typo s,   bg b           ,   fg f =   fg::none) : mode(ansi::colors_16), style(s), fore(f), back(b) {}
-                fmt(fg_256 f, bg_256 b, typo s = typo::none) : mode(ansi::colors_256), style(s), fore_256(f),        back_256(b) {}
-                fmt(fg_256 f, typo s = typo::none)           : mode(ansi::colors_256), style(s), fore_256(f),        back_256(bg::none) {}
-                fmt(fg, bg_256 b, typo s = typo::none)       : mode(ansi::colors_256), style(s), fore_256(fg::none), back_256(b) {}
+                fmt() : _mode(ansi::colors_16), _style(typo::none), _fore(fg::none), _back(bg::none) {}
+                fmt(  fg f,   bg b = bg::none, typo s = typo::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {}
+                fmt(  fg f, typo s           ,   bg b =   bg::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {}
+                fmt(  bg b,   fg f = fg::none, typo s = typo::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {}
+                fmt(  bg b, typo s           ,   fg f =   fg::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {}
+                fmt(typo s,   fg f = fg::none,   bg b =   bg::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {}
+                fmt(typo s,   bg b           ,   fg f =   fg::none) : _mode(ansi::colors_16), _style(s), _fore(f), _back(b) {}
+                fmt(fg_256 f, bg_256 b, typo s = typo::none) : _mode(ansi::colors_256), _style(s), _fore(fg::none), _back(bg::none), fore_256(f),        back_256(b) {}
+                fmt(fg_256 f, typo s = typo::none)           : _mode(ansi::colors_256), _style(s), _fore(fg::none), _back(bg::none), fore_256(f),        back_256(bg::none) {}
+                fmt(fg, bg_256 b, typo s = typo::none)       : _mode(ansi::colors_256), _style(s), _fore(fg::none), _back(bg::none), fore_256(fg::none), back_256(b) {}
                 fmt(const short fr, const short fg, const short fb,
                     const short gr, const short gg, const short gb,
                     typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fr,fg,fb), back_16M(gr,gg,gb) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fr,fg,fb), back_16M(gr,gg,gb) {}
                 fmt(fg,
                     const short gr, const short gg, const short gb,
                     typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fg::none), back_16M(gr,gg,gb) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fg::none), back_16M(gr,gg,gb) {}
                 fmt(const short fr, const short fg, const short fb,
                     bg, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fr,fg,fb), back_16M(bg::none) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fr,fg,fb), back_16M(bg::none) {}
                 fmt(const short fr, const short fg, const short fb,
                     typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fr,fg,fb), back_16M(bg::none) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fr,fg,fb), back_16M(bg::none) {}
 
                 fmt(const std::string& f, const std::string& b, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(f), back_16M(b) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(f), back_16M(b) {}
                 fmt(fg, const std::string& b, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(fg::none), back_16M(b) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(fg::none), back_16M(b) {}
                 fmt(const std::string& f, bg, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(f), back_16M(bg::none) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(f), back_16M(bg::none) {}
                 fmt(const std::string& f, typo s = typo::none)
-                    : mode(ansi::colors_16M), style(s), fore_16M(f), back_16M(bg::none) {}
+                    : _mode(ansi::colors_16M), _style(s), _fore(fg::none), _back(bg::none), fore_16M(f), back_16M(bg::none) {}
+                ansi mode() const { return _mode; }
+                void style(const typo) {}
+                typo style() const { return _style; }
+                void fore(const fg) {}
+                fg fore() const { return _fore; }
+                void back(const bg) {}
+                bg back() const { return _back; }
             protected:
                 std::ostream& print_on( std::ostream&) const {}
             public:
                 friend std::ostream& operator<<(std::ostream& os, const fmt&) { return os; }
                 std::string operator()( const std::string& msg) const { return msg; }
                 std::string str() const { return ""; }
-                static fmt hash( const std::string&, const std::vector<fmt>) {}
+                std::string_view escape() const { return {}; }
+                static constexpr std::string_view reset_escape = "";
+                static constexpr size_t escape_capacity = 48;
+                static fmt hash( const std::string&, const std::vector<fmt>&) {}
+                static fmt hash( const size_t, const std::vector<fmt>&) {}
         };
     public:
         clutchlog(clutchlog const&)      = delete;
@@ -1629,6 +5231,17 @@ class clutchlog
         clutchlog() {}
     protected:
         struct scope_t {};
+    public:
+        struct site_t {
+            site_t(const level&, const char*, const char*, const size_t) {}
+            bool passes(const clutchlog&) { return false; }
+            switching state() { return switching::follow; }
+            void state(const switching) {}
+        };
+        std::vector<site_t*> sites() const { return {}; }
+        template<class P>
+        size_t switch_sites(const switching, P) { return 0; }
+    protected:
         scope_t locate(
                 const level&,
                 const std::string&,
@@ -1638,13 +5251,29 @@ class clutchlog
         {}
     public:
         void format(const std::string&) {}
+        template<const char*>
+        void format() {}
         std::string format() const { return ""; }
 
         void format_comment(const std::string&) {}
+        template<const char*>
+        void format_comment() {}
         std::string format_comment() const { return ""; }
+        void dump_mode(const dumping) {}
+        dumping dump_mode() const { return dumping::text; }
+        static void undump(const std::string_view, std::ostream&, const std::string& = "") {}
+        void out_mode(const encoding) {}
+        encoding out_mode() const { return encoding::formatted; }
+        void decode(const std::string_view, std::ostream&, const bool = false, const std::string& = "") const {}
 
         void out(std::ostream&) {}
         std::ostream& out() {}
+        void out_fd(const int) {}
+        int out_fd() const { return -1; }
+        size_t add_sink(std::ostream&, const level, const std::string& = "", const bool = true) { return 0; }
+        void remove_sink(const size_t) {}
+        void sink_threshold(const size_t, const level) {}
+        level sink_threshold(const size_t) const { return level::error; }
 
 #if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
         void depth(size_t) {}
@@ -1652,6 +5281,8 @@ class clutchlog
 
         void depth_mark(const std::string) {}
         std::string depth_mark() const { return ""; }
+        void name(const std::string&) {}
+        std::string name() const { return ""; }
         void strip_calls(const size_t) {}
         size_t strip_calls() const { return 0; }
 #endif
@@ -1660,8 +5291,14 @@ class clutchlog
         char hfill_mark() const { return '\0'; }
         void hfill_fmt(fmt) {}
         fmt hfill_fmt() const { return fmt(); }
+        void hfill_style(fmt) {}
+        template<class ... FMT>
+        void hfill_style(FMT...) {}
+        fmt hfill_style() const { return fmt(); }
         void hfill_min(const size_t) {}
         size_t hfill_min() { return 0; }
+        void hfill_watch(const bool) {}
+        bool hfill_watch() const { return false; }
         void hfill_max(const size_t) {}
         size_t hfill_max() { return 0; }
 #endif
@@ -1674,6 +5311,10 @@ class clutchlog
         level threshold() const { return level::error; }
         const std::map<std::string,level> levels() const {}
         level level_of(const std::string) { return level::error; }
+        void level_word(const level, const std::string&) {}
+        const std::string& level_word(const level) const { static const std::string none; return none; }
+        void level_short(const level, const std::string&) {}
+        const std::string& level_short(const level) const { static const std::string none; return none; }
 
         void file(std::string) {}
         void func(std::string) {}
@@ -1693,6 +5334,23 @@ class clutchlog
         void style(level, fmt) {}
         fmt style(level) const { return fmt(); }
         void filename(filename) {}
+        static constexpr std::string_view filename_of(const std::string_view file, const enum filename) { return file; }
+        void async(const bool) {}
+        bool async() const { return false; }
+        void async_capacity(const size_t) {}
+        size_t async_capacity() const { return 0; }
+        void async_overflow(const overflow) {}
+        overflow async_overflow() const { return overflow::block; }
+        size_t async_dropped() const { return 0; }
+        void flush_policy(const flushing) {}
+        flushing flush_policy() const { return flushing::always; }
+        void flush_level(const level) {}
+        level flush_level() const { return level::error; }
+        void flush_n(const size_t) {}
+        size_t flush_n() const { return 1; }
+        void flush_ms(const size_t) {}
+        size_t flush_ms() const { return 0; }
+        void flush() {}
     public:
         std::string replace(
                 const std::string& form,
@@ -1738,6 +5396,15 @@ class clutchlog
             ) const
         {}
 
+        template<class W>
+        void log(
+                const level&,
+                W,
+                const std::string&, const std::string&, size_t,
+                const size_t = 0
+            ) const
+        {}
+
         template<class In>
         void dump(
                 const level&,
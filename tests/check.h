@@ -0,0 +1,16 @@
+#ifndef CLUTCHLOG_TESTS_CHECK_H
+#define CLUTCHLOG_TESTS_CHECK_H
+
+#include <iostream>
+#include <cstdlib>
+
+//! Like `assert`, but also checked if NDEBUG is defined (e.g. in Release builds).
+#define CHECK( ... ) do {                                                                \
+    if(not (__VA_ARGS__)) {                                                             \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #__VA_ARGS__  \
+                  << std::endl;                                                         \
+        std::abort();                                                                   \
+    }                                                                                   \
+} while(0)
+
+#endif // CLUTCHLOG_TESTS_CHECK_H
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    log.format("{msg}\n");
+    log.threshold(clutchlog::level::xdebug);
+    log.style(clutchlog::level::info, clutchlog::fmt());
+
+#ifdef WITH_CLUTCHLOG
+    const size_t n = 1000;
+
+    // Blocking: every message is written, in order.
+    std::ostringstream out;
+    log.out(out);
+    log.async_capacity(16);
+    log.async(true);
+    CHECK(log.async());
+    for(size_t i = 0; i < n; ++i) {
+        CLUTCHLOG(info, i);
+    }
+    log.async(false);
+    std::ostringstream expected;
+    for(size_t i = 0; i < n; ++i) {
+        expected << i << "\n" << clutchlog::fmt(clutchlog::fmt::typo::reset);
+    }
+    CHECK(out.str() == expected.str());
+    CHECK(log.async_dropped() == 0);
+
+    // Several producers: every message is written.
+    out.str("");
+    log.async(true);
+    std::vector<std::thread> producers;
+    for(size_t t = 0; t < 4; ++t) {
+        producers.emplace_back([&log,n](){
+            for(size_t i = 0; i < n; ++i) {
+                log.log(clutchlog::level::info, "x", "file", "func", 0);
+            }
+        });
+    }
+    for(auto& p : producers) { p.join(); }
+    log.async(false);
+    size_t lines = 0;
+    for(char c : out.str()) { if(c == '\n') { lines++; } }
+    CHECK(lines == 4*n);
+
+    // Dropping: messages are either written or counted as dropped.
+    for(auto policy : {clutchlog::overflow::drop_newest, clutchlog::overflow::drop_oldest}) {
+        out.str("");
+        const size_t before = log.async_dropped();
+        log.async_capacity(2);
+        log.async_overflow(policy);
+        log.async(true);
+        for(size_t i = 0; i < n; ++i) {
+            CLUTCHLOG(info, i);
+        }
+        log.async(false);
+        lines = 0;
+        for(char c : out.str()) { if(c == '\n') { lines++; } }
+        CHECK(lines + log.async_dropped() - before == n);
+    }
+
+    // Critical messages are written before the call returns.
+    out.str("");
+    log.async_overflow(clutchlog::overflow::block);
+    log.async(true);
+    CLUTCHLOG(critical, "flushed");
+    CHECK(out.str().find("flushed") != std::string::npos);
+    log.async(false);
+#endif
+
+    log.out(std::clog);
+    CLUTCHLOG(info, "async: ok");
+}
@@ -1,37 +1,46 @@
+#include <atomic>
 #include <iostream>
+#include <sstream>
 #include <limits>
 
 #include "../clutchlog/clutchlog.h"
+#include "check.h"
 
-void deepcall()
+// Not inlined nor called as tail calls (hence the fences),
+// so that each call counts in the backtrace, even in Release builds.
+
+[[gnu::noinline]] void deepcall()
 {
     CLUTCHLOG(warning,"at depth 4");
     CLUTCHLOGD(warning,"at depth 4+1", 1);
     CLUTCHLOGD(warning,"at depth 4+2", 2);
 }
 
-void subsubsubcall()
+[[gnu::noinline]] void subsubsubcall()
 {
     CLUTCHLOG(warning,"at depth 3");
     CLUTCHLOGD(warning,"at depth 3+1", 1);
     CLUTCHLOGD(warning,"at depth 3+2", 2);
     deepcall();
+    std::atomic_signal_fence(std::memory_order_seq_cst);
 }
 
-void subsubcall()
+[[gnu::noinline]] void subsubcall()
 {
     CLUTCHLOG(warning,"at depth 2");
     CLUTCHLOGD(warning,"at depth 2+1", 1);
     CLUTCHLOGD(warning,"at depth 2+2", 2);
     subsubsubcall();
+    std::atomic_signal_fence(std::memory_order_seq_cst);
 }
 
-void subcall()
+[[gnu::noinline]] void subcall()
 {
     CLUTCHLOG(warning,"at depth 1");
     CLUTCHLOGD(warning,"at depth 1+1", 1);
     CLUTCHLOGD(warning,"at depth 1+2", 2);
     subsubcall();
+    std::atomic_signal_fence(std::memory_order_seq_cst);
 }
 
 int main(/*const int argc, char* argv[]*/)
@@ -54,5 +63,31 @@ int main(/*const int argc, char* argv[]*/)
 
     CLUTCHLOG(warning,"in main");
     subcall();
+
+    // Check the actual depths, as measured with backtrace.
+    std::ostringstream out;
+    log.out(out);
+    log.format("{depth} ");
+    log.style(clutchlog::level::warning, fmt());
+    CLUTCHLOG(warning,"in main");
+    subcall();
+    std::clog << out.str() << std::endl;
+#if defined(WITH_CLUTCHLOG) and CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+    const std::string r = "\033[0m"; // Reset at the end of each message.
+    CHECK(out.str() == "1 "+r+"2 "+r+"3 "+r+"4 "+r+"3 "+r+"4 "+r+"5 "+r+"4 "+r+"5 "+r+"6 "+r+"5 "+r+"6 "+r+"7 "+r);
+
+#ifndef NDEBUG
+    // The call without a macro counts the same (unless log() is inlined by an optimized build).
+    out.str("");
+    log.log(clutchlog::level::warning, "", CLUTCHLOC);
+    CHECK(out.str() == "1 "+r);
+#endif
+
+    // Limit the depth.
+    out.str("");
+    log.depth(3);
+    subcall();
+    CHECK(out.str() == "2 "+r+"3 "+r+"4 "+r+"3 "+r+"4 "+r+"5 "+r);
+#endif
 }
 
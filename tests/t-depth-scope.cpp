@@ -0,0 +1,86 @@
+#include <iostream>
+#include <sstream>
+#include <limits>
+
+// Count depth with CLUTCHSCOPE instead of backtrace.
+#define CLUTCHLOG_DEPTH_SCOPE 1
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+void deepcall()
+{
+    CLUTCHSCOPE();
+    CLUTCHLOG(warning,"at depth 4");
+    CLUTCHLOGD(warning,"at depth 4+1", 1);
+    CLUTCHLOGD(warning,"at depth 4+2", 2);
+}
+
+void subsubsubcall()
+{
+    CLUTCHSCOPE();
+    CLUTCHLOG(warning,"at depth 3");
+    CLUTCHLOGD(warning,"at depth 3+1", 1);
+    CLUTCHLOGD(warning,"at depth 3+2", 2);
+    deepcall();
+}
+
+void subsubcall()
+{
+    CLUTCHSCOPE();
+    CLUTCHLOG(warning,"at depth 2");
+    CLUTCHLOGD(warning,"at depth 2+1", 1);
+    CLUTCHLOGD(warning,"at depth 2+2", 2);
+    subsubsubcall();
+}
+
+void subcall()
+{
+    CLUTCHSCOPE();
+    CLUTCHLOG(warning,"at depth 1");
+    CLUTCHLOGD(warning,"at depth 1+1", 1);
+    CLUTCHLOGD(warning,"at depth 1+2", 2);
+    subsubcall();
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+    CLUTCHSCOPE();
+    auto& log = clutchlog::logger();
+    using fmt = clutchlog::fmt;
+    using typo = clutchlog::fmt::typo;
+
+    // Same output than t-depth-delta.
+    fmt reset(typo::reset);
+    std::ostringstream tpl;
+    tpl << "{depth_fmt}{depth} {depth_marks}"
+        << reset << "{funchash_fmt}in {func} {msg}\t\n";
+    log.format(tpl.str());
+    log.threshold(clutchlog::level::xdebug);
+    std::vector<fmt> greys = {fmt(15)};
+    for(unsigned short i=255; i > 231; i-=3) {
+        greys.push_back( fmt(i) ); }
+    log.depth_styles( greys );
+    log.depth_mark("| ");
+
+    CLUTCHLOG(warning,"in main");
+    subcall();
+
+    // Check the actual depths, as measured with backtrace in t-depth-delta.
+    std::ostringstream out;
+    log.out(out);
+    log.format("{depth} ");
+    log.style(clutchlog::level::warning, fmt());
+    CLUTCHLOG(warning,"in main");
+    subcall();
+    std::clog << out.str() << std::endl;
+#ifdef WITH_CLUTCHLOG
+    const std::string r = "\033[0m"; // Reset at the end of each message.
+    CHECK(out.str() == "1 "+r+"2 "+r+"3 "+r+"4 "+r+"3 "+r+"4 "+r+"5 "+r+"4 "+r+"5 "+r+"6 "+r+"5 "+r+"6 "+r+"7 "+r);
+
+    // Limit the depth.
+    out.str("");
+    log.depth(3);
+    subcall();
+    CHECK(out.str() == "2 "+r+"3 "+r+"4 "+r+"3 "+r+"4 "+r+"5 "+r);
+#endif
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+std::string content(const std::string& filename)
+{
+    std::ifstream fd(filename, std::ios::binary);
+    std::ostringstream all;
+    all << fd.rdbuf();
+    return all.str();
+}
+
+std::string undumped(const std::string& filename)
+{
+    std::ostringstream text;
+    clutchlog::undump(content(filename), text);
+    return text.str();
+}
+
+struct point { short x, y; };
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format_comment("# {level} in {func}");
+
+    const std::vector<double> reals = {0.5, -1.25, 3.14159265, 1e-20};
+    const std::vector<int> ints = {-2, 0, 42};
+    const char chars[] = {'a', 'b', 'c'};
+
+    // Reference text dumps.
+    CLUTCHDUMP(info, reals, "t-dump-binary_reals.txt");
+    CLUTCHDUMP(info, ints, "t-dump-binary_ints.txt");
+    CLUTCHDUMP(info, chars, "t-dump-binary_chars.txt");
+
+    log.dump_mode(clutchlog::binary);
+    CLUTCHDUMP(info, reals, "t-dump-binary_reals.bin");
+    CLUTCHDUMP(info, ints, "t-dump-binary_ints.bin");
+    CLUTCHDUMP(info, chars, "t-dump-binary_chars.bin");
+
+    // The items are raw and aligned after the header.
+    const std::string reals_bin = content("t-dump-binary_reals.bin");
+    CHECK(reals_bin.rfind("clutchdump 1 ", 0) == 0);
+    CHECK(reals_bin.find(" in main") != std::string::npos);
+    CHECK(reals_bin.size() % clutchlog::dump_alignment == 0);
+    const char* raw = reals_bin.data() + reals_bin.size() - reals.size() * sizeof(double);
+    CHECK(std::memcmp(raw, reals.data(), reals.size() * sizeof(double)) == 0);
+
+    // Converted back, they read as the text dumps.
+    CHECK(undumped("t-dump-binary_reals.bin") == content("t-dump-binary_reals.txt"));
+    CHECK(undumped("t-dump-binary_ints.bin") == content("t-dump-binary_ints.txt"));
+    CHECK(undumped("t-dump-binary_chars.bin") == content("t-dump-binary_chars.txt"));
+
+    // Non-arithmetic items are converted as hexadecimal bytes.
+    const std::vector<point> points = {{1, 2}};
+    CLUTCHDUMP(info, points, "t-dump-binary_points.bin");
+    CHECK(undumped("t-dump-binary_points.bin").find("01000200\n") != std::string::npos);
+
+    // Containers that cannot be dumped as raw bytes are still dumped as text.
+    const std::vector<std::string> words = {"hello", "world"};
+    CLUTCHDUMP(info, words, "t-dump-binary_words.txt");
+    CHECK(content("t-dump-binary_words.txt").find(" in main") != std::string::npos);
+    CHECK(content("t-dump-binary_words.txt").find("\nhello\nworld\n") != std::string::npos);
+
+    // Without comment line.
+    log.format_comment("");
+    CLUTCHDUMP(info, ints, "t-dump-binary_nocomment.bin");
+    CHECK(undumped("t-dump-binary_nocomment.bin") == "-2\n0\n42\n");
+
+    bool thrown = false;
+    try {
+        clutchlog::undump(content("t-dump-binary_words.txt"), std::cout);
+    } catch(const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    for(const std::string name : {"reals", "ints", "chars"}) {
+        std::remove(("t-dump-binary_" + name + ".txt").c_str());
+        std::remove(("t-dump-binary_" + name + ".bin").c_str());
+    }
+    std::remove("t-dump-binary_points.bin");
+    std::remove("t-dump-binary_words.txt");
+    std::remove("t-dump-binary_nocomment.bin");
+#endif
+}
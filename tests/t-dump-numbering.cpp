@@ -0,0 +1,76 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+void touch(const fs::path& file)
+{
+    std::ofstream fd(file);
+}
+
+size_t count(const fs::path& dir)
+{
+    size_t n = 0;
+    for(auto& entry : fs::directory_iterator(dir)) {
+        n += entry.is_regular_file();
+    }
+    return n;
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+
+    const fs::path dir = "t-dump-numbering_dir";
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    const std::string tpl = (dir / "dump_{n}.dat").string();
+
+    // Files from a previous run, and files which do not match the template.
+    touch(dir / "dump_0.dat");
+    touch(dir / "dump_5.dat");
+    touch(dir / "dump_x.dat");
+    touch(dir / "dump_7.txt");
+    touch(dir / "other_9.dat");
+
+    const std::vector<int> v = {1, 2, 3};
+
+    // Numbering goes on after the largest existing number.
+    CLUTCHDUMP(info, v, tpl);
+    CHECK(fs::exists(dir / "dump_6.dat"));
+    CLUTCHDUMP(info, v, tpl);
+    CHECK(fs::exists(dir / "dump_7.dat"));
+
+    // A file created in between (e.g. by another process) is never overwritten.
+    std::ofstream(dir / "dump_8.dat") << "other";
+    CLUTCHDUMP(info, v, tpl);
+    CHECK(fs::exists(dir / "dump_9.dat"));
+    std::ifstream other(dir / "dump_8.dat");
+    std::string word;
+    other >> word;
+    CHECK(word == "other");
+
+    // Concurrent dumps never share a file.
+    const size_t before = count(dir);
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&](){
+            for(size_t i = 0; i < 10; ++i) {
+                CLUTCHDUMP(info, v, tpl);
+            }
+        });
+    }
+    for(auto& t : threads) { t.join(); }
+    CHECK(count(dir) == before + 40);
+
+    fs::remove_all(dir);
+#endif
+}
@@ -0,0 +1,42 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Calls to less important levels than warning generate no code at all.
+#define CLUTCHLOG_MIN_LEVEL clutchlog::level::warning
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+//! True if the given string is somewhere in the binary of this program.
+bool in_binary(const std::string& key)
+{
+    std::ifstream exe("/proc/self/exe", std::ios::binary);
+    const std::string binary((std::istreambuf_iterator<char>(exe)), std::istreambuf_iterator<char>());
+    return binary.find(key) != std::string::npos;
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+
+    CLUTCHLOG(warning, "clutchlog kept message");
+    CLUTCHLOG(info, "clutchlog eliminated message");
+    CLUTCHLOGD(debug, "clutchlog eliminated message with delta", 1);
+    std::vector<int> data = {1, 2, 3};
+    CLUTCHDUMP(xdebug, data, "clutchlog_eliminated_dump.dat");
+    CLUTCHCODE(note, std::clog << "clutchlog eliminated code" << std::endl;);
+
+    // Built at run time, so that the searched strings do not appear themselves.
+    const std::string clutchlog = std::string("clutch") + "log ";
+    if(std::ifstream("/proc/self/exe")) {
+#ifdef WITH_CLUTCHLOG
+        CHECK(in_binary(clutchlog + "kept message"));
+#endif
+        CHECK(not in_binary(clutchlog + "eliminated message"));
+        CHECK(not in_binary(std::string("clutchlog_") + "eliminated_dump"));
+        CHECK(not in_binary(clutchlog + "eliminated code"));
+    }
+}
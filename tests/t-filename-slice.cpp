@@ -0,0 +1,59 @@
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    // Computed at compile time.
+    static_assert(clutchlog::filename_of("/a/b/c.cpp", clutchlog::filename::path)    == "/a/b/c.cpp");
+    static_assert(clutchlog::filename_of("/a/b/c.cpp", clutchlog::filename::base)    == "c.cpp");
+    static_assert(clutchlog::filename_of("/a/b/c.cpp", clutchlog::filename::dir)     == "b");
+    static_assert(clutchlog::filename_of("/a/b/c.cpp", clutchlog::filename::dirbase) == "b/c.cpp");
+    static_assert(clutchlog::filename_of("/a/b/c.cpp", clutchlog::filename::stem)    == "c");
+    static_assert(clutchlog::filename_of("/a/b/c.cpp", clutchlog::filename::dirstem) == "b/c");
+
+    // Same as what std::filesystem would give, for paths having a directory.
+    const std::string paths[] = {
+        "/a/b/c.cpp", "a/b.tar.gz", "/c.h", "../d/.hidden", "x/y/noext", __FILE__
+    };
+    for(const std::string& file : paths) {
+        const std::filesystem::path path(file);
+        auto ip = path.end();
+        std::advance(ip, -2);
+        CHECK(clutchlog::filename_of(file, clutchlog::filename::path)    == path.string());
+        CHECK(clutchlog::filename_of(file, clutchlog::filename::base)    == path.filename().string());
+        CHECK(clutchlog::filename_of(file, clutchlog::filename::dir)     == ip->string());
+        CHECK(clutchlog::filename_of(file, clutchlog::filename::dirbase) == (*ip / path.filename()).string());
+        CHECK(clutchlog::filename_of(file, clutchlog::filename::stem)    == path.stem().string());
+        CHECK(clutchlog::filename_of(file, clutchlog::filename::dirstem) == (*ip / path.stem()).string());
+    }
+
+    // Without a directory.
+    static_assert(clutchlog::filename_of("c.cpp", clutchlog::filename::dir)     == "");
+    static_assert(clutchlog::filename_of("c.cpp", clutchlog::filename::dirstem) == "c");
+
+    // Call sites and direct calls display the same.
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format("{file}\n");
+    for(const auto method : {clutchlog::filename::path, clutchlog::filename::base, clutchlog::filename::dir,
+                             clutchlog::filename::dirbase, clutchlog::filename::stem, clutchlog::filename::dirstem}) {
+        log.filename(method);
+        std::ostringstream site, direct;
+        log.out(site);
+        CLUTCHLOG(info, "");
+        log.out(direct);
+        log.log(clutchlog::level::info, "", __FILE__, __FUNCTION__, __LINE__);
+        CHECK(site.str() == direct.str());
+        // The row is followed by a reset escape.
+        CHECK(site.str().rfind(std::string(clutchlog::filename_of(__FILE__, method)) + "\n", 0) == 0);
+    }
+    log.out(std::clog);
+#endif
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+//! A string buffer counting how many times it is flushed.
+class counting_buf : public std::stringbuf {
+    public:
+        size_t syncs = 0;
+    protected:
+        int sync() override { syncs++; return std::stringbuf::sync(); }
+};
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    log.format("{msg}\n");
+    log.threshold(clutchlog::level::xdebug);
+
+    counting_buf buf;
+    std::ostream out(&buf);
+    log.out(out);
+
+#ifdef WITH_CLUTCHLOG
+    // Default: flush after each message.
+    CHECK(log.flush_policy() == clutchlog::flushing::always);
+    for(size_t i = 0; i < 10; ++i) { CLUTCHLOG(info, i); }
+    CHECK(buf.syncs == 10);
+
+    // Flush only after important messages.
+    log.flush_policy(clutchlog::flushing::on_level);
+    buf.syncs = 0;
+    log.flush_level(clutchlog::level::warning);
+    for(size_t i = 0; i < 10; ++i) { CLUTCHLOG(info, i); }
+    CHECK(buf.syncs == 0);
+    CLUTCHLOG(warning, "flushed");
+    CLUTCHLOG(error, "flushed");
+    CHECK(buf.syncs == 2);
+
+    // Flush every n messages.
+    log.flush_policy(clutchlog::flushing::every_n);
+    buf.syncs = 0;
+    log.flush_n(4);
+    for(size_t i = 0; i < 10; ++i) { CLUTCHLOG(info, i); }
+    CHECK(buf.syncs == 2);
+
+    // Flush after some time.
+    log.flush_policy(clutchlog::flushing::every_ms);
+    buf.syncs = 0;
+    log.flush_ms(50);
+    for(size_t i = 0; i < 10; ++i) { CLUTCHLOG(info, i); }
+    CHECK(buf.syncs == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    CLUTCHLOG(info, "flushed");
+    CHECK(buf.syncs == 1);
+
+    // Changing the policy flushes the waiting messages.
+    for(size_t i = 0; i < 10; ++i) { CLUTCHLOG(info, i); }
+    CHECK(buf.syncs == 1);
+    log.flush_policy(clutchlog::flushing::every_n);
+    CHECK(buf.syncs == 2);
+    log.flush_policy(clutchlog::flushing::every_ms);
+
+    // In asynchronous mode, the writer flushes once idle.
+    buf.syncs = 0;
+    log.async(true);
+    for(size_t i = 0; i < 10; ++i) { CLUTCHLOG(info, i); }
+    for(size_t t = 0; t < 100 and buf.syncs == 0; ++t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(buf.syncs > 0);
+    log.async(false);
+
+    // Flush only on demand.
+    log.flush_policy(clutchlog::flushing::manual);
+    buf.syncs = 0;
+    for(size_t i = 0; i < 10; ++i) { CLUTCHLOG(critical, i); }
+    CHECK(buf.syncs == 0);
+    log.flush();
+    CHECK(buf.syncs == 1);
+
+    // Changing the output stream flushes the previous one.
+    CLUTCHLOG(info, "last");
+    log.out(std::clog);
+    CHECK(buf.syncs == 2);
+#endif
+
+    log.flush_policy(clutchlog::flushing::always);
+    CLUTCHLOG(info, "flush: ok");
+}
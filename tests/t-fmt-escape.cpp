@@ -0,0 +1,59 @@
+#include <iostream>
+#include <sstream>
+
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    using fmt = clutchlog::fmt;
+    using fg = clutchlog::fmt::fg;
+    using bg = clutchlog::fmt::bg;
+    using typo = clutchlog::fmt::typo;
+
+    // 16 colors mode: a single escape.
+    CHECK(fmt().escape() == "");
+    CHECK(fmt(fg::red).escape() == "\033[31m");
+    CHECK(fmt(fg::red, bg::bright_white, typo::bold).escape() == "\033[31;107;1m");
+    CHECK(fmt(typo::reset).escape() == fmt::reset_escape);
+
+    // 256 colors mode: separated escapes.
+    CHECK(fmt(255).escape() == "\033[38;5;255m");
+    CHECK(fmt(fg::none, 0, typo::inverse).escape() == "\033[48;5;0m\033[7m");
+
+    // 16M colors mode: separated escapes.
+    CHECK(fmt(255,0,10, typo::underline).escape() == "\033[38;2;255;0;10m\033[4m");
+    CHECK(fmt("#ff000a", "#0000ff").escape() == "\033[38;2;255;0;10m\033[48;2;0;0;255m");
+    CHECK(fmt(255,255,255, 255,255,255, typo::inverse).escape().size() < fmt::escape_capacity);
+
+    // The other ways to get the escape agree.
+    const fmt f(fg::green, typo::bold);
+    std::ostringstream os;
+    os << f;
+    CHECK(os.str() == f.escape());
+    CHECK(f.str() == f.escape());
+    CHECK(f("msg") == std::string(f.escape()) + "msg" + std::string(fmt::reset_escape));
+
+    // Copies hold their own escape.
+    const fmt g = f;
+    CHECK(g.escape() == f.escape());
+    CHECK(g.escape().data() != f.escape().data());
+
+    // Setters render the escape again.
+    fmt h(fg::red);
+    h.back(bg::bright_white);
+    h.style(typo::bold);
+    CHECK(h.escape() == "\033[31;107;1m");
+    CHECK(h.fore() == fg::red and h.back() == bg::bright_white and h.style() == typo::bold);
+    h.fore(fg::none);
+    CHECK(h.escape() == "\033[107;1m");
+    fmt k(255, 0);
+    CHECK(k.mode() == fmt::ansi::colors_256);
+    k.back(bg::none);
+    k.style(typo::underline);
+    CHECK(k.escape() == "\033[38;5;255m\033[4m");
+
+    std::cout << f("Escapes are rendered ahead.") << std::endl;
+#endif
+}
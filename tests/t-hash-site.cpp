@@ -0,0 +1,45 @@
+#include <iostream>
+#include <sstream>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    using fmt = clutchlog::fmt;
+    using level = clutchlog::level;
+
+    log.threshold(level::xdebug);
+    log.style(level::info, fmt());
+    log.format("{filehash_fmt}{file}{funchash_fmt}{func}\n");
+
+    // A call site and a direct call at the same location have the same styles.
+    std::ostringstream site, direct;
+    log.out(site);
+    CLUTCHLOG(info, "");
+    log.out(direct);
+    log.log(level::info, "", __FILE__, __FUNCTION__, __LINE__);
+    CHECK(site.str() == direct.str());
+
+    // Changing the candidate styles is followed by the call sites.
+    const std::vector<fmt> styles = {fmt(fmt::fg::red, fmt::typo::underline)};
+    log.filehash_styles(styles);
+    log.funchash_styles(styles);
+    for(size_t i = 0; i < 2; ++i) {
+        std::ostringstream styled;
+        log.out(styled);
+        CLUTCHLOG(info, "");
+#ifdef WITH_CLUTCHLOG
+        const std::string style(styles.front().escape());
+        CHECK(styled.str().find(style + __FILE__) != std::string::npos);
+        CHECK(styled.str().find(style + __FUNCTION__) != std::string::npos);
+#endif
+    }
+
+    log.out(std::clog);
+    log.format("{filehash_fmt}{file} {funchash_fmt}{func}{msg}\n");
+    CLUTCHLOG(info, " (styles computed once per call site)");
+}
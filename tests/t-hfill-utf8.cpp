@@ -0,0 +1,49 @@
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.style(clutchlog::level::info, clutchlog::fmt());
+    log.format("{msg}{hfill}{func}\n");
+    log.hfill_mark('.');
+    log.hfill_style(clutchlog::fmt());
+    // Fixed width, whatever the terminal.
+    log.hfill_min(40);
+    log.hfill_max(40);
+
+    std::ostringstream ascii;
+    log.out(ascii);
+    CLUTCHLOG(info, "abc");
+
+    std::ostringstream utf8;
+    log.out(utf8);
+    CLUTCHLOG(info, "αβγ"); // Two bytes per character.
+
+    std::ostringstream styled;
+    log.out(styled);
+    CLUTCHLOG(info, clutchlog::fmt(clutchlog::fmt::fg::red)("a→c")); // Escapes are not displayed.
+
+    log.out(std::clog);
+    CLUTCHLOG(info, "abc");
+    CLUTCHLOG(info, "αβγ");
+    CLUTCHLOG(info, clutchlog::fmt(clutchlog::fmt::fg::red)("a→c"));
+
+#ifdef WITH_CLUTCHLOG
+    // The same number of filling characters, hence the same alignment.
+    const auto dots = [](const std::ostringstream& out) {
+        const std::string s = out.str();
+        return std::count(s.begin(), s.end(), '.');
+    };
+    CHECK(dots(ascii) > 0);
+    CHECK(dots(utf8) == dots(ascii));
+    CHECK(dots(styled) == dots(ascii));
+#endif
+}
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <sstream>
+#include <csignal>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+volatile std::sig_atomic_t user_resized = 0;
+void on_user_resize(int) { user_resized = 1; }
+
+size_t line_width(const size_t nmin)
+{
+    auto& log = clutchlog::logger();
+    log.hfill_min(nmin);
+    std::ostringstream out;
+    log.out(out);
+    CLUTCHLOG(info, "abc");
+    return out.str().size();
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.style(clutchlog::level::info, clutchlog::fmt());
+    log.format("{msg}{hfill}{func}\n");
+    log.hfill_style(clutchlog::fmt());
+    log.hfill_max(300);
+
+#ifdef WITH_CLUTCHLOG
+    // A string stream is not a terminal: it is filled up to the minimum width.
+    CHECK(line_width(60) - line_width(40) == 20);
+#endif
+
+    // A previously installed handler is still called.
+    std::signal(SIGWINCH, on_user_resize);
+    log.hfill_watch(true);
+    std::raise(SIGWINCH);
+    CHECK(user_resized == 1);
+#ifdef WITH_CLUTCHLOG
+    CHECK(line_width(50) - line_width(40) == 10);
+#endif
+
+    // And is restored afterwards.
+    log.hfill_watch(false);
+    user_resized = 0;
+    std::raise(SIGWINCH);
+    CHECK(user_resized == 1);
+
+    log.out(std::clog);
+    CLUTCHLOG(info, "Resize the terminal to see the next lines follow.");
+    log.hfill_watch(true);
+    CLUTCHLOG(info, "abc");
+}
@@ -0,0 +1,40 @@
+#include <iostream>
+#include <sstream>
+
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    auto& log = clutchlog::logger();
+    using level = clutchlog::level;
+
+    log.threshold(level::xdebug);
+    log.style(level::warning, clutchlog::fmt());
+    log.format("{level_letter}|{level_short}|{level}\n");
+
+    std::ostringstream out;
+    log.out(out);
+    CLUTCHLOG(warning, "");
+    CHECK(out.str().find("W|Warn|Warning\n") == 0);
+
+    // Renaming a level.
+    log.level_word(level::warning, "Caution");
+    log.level_short(level::warning, "Caut");
+    CHECK(log.level_word(level::warning) == "Caution");
+    CHECK(log.level_short(level::warning) == "Caut");
+    CHECK(log.level_of("Caution") == level::warning);
+    try {
+        log.level_of("Warning");
+        CHECK(false);
+    } catch(std::out_of_range&) {}
+
+    std::ostringstream renamed;
+    log.out(renamed);
+    CLUTCHLOG(warning, "");
+    CHECK(renamed.str().find("C|Caut|Caution\n") == 0);
+
+    log.out(std::clog);
+#endif
+}
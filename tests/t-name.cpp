@@ -0,0 +1,34 @@
+#include <iostream>
+#include <sstream>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.style(clutchlog::level::info, clutchlog::fmt());
+
+#ifdef WITH_CLUTCHLOG
+    // Found once, by looking at the running process.
+    CHECK(log.name() == "t-name");
+
+    std::ostringstream out;
+    log.out(out);
+    log.format("[{name}] {msg}\n");
+    CLUTCHLOG(info, "found");
+    CHECK(out.str().find("[t-name] found") == 0);
+
+    // Set by the user.
+    out.str("");
+    log.name("renamed");
+    CLUTCHLOG(info, "set");
+    CHECK(out.str().find("[renamed] set") == 0);
+#endif
+
+    log.out(std::clog);
+    CLUTCHLOG(info, "name: ok");
+}
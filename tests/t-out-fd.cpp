@@ -0,0 +1,88 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+//! Content of the file, without the style resets ending the messages.
+std::string content(const std::string& path)
+{
+    std::ifstream in(path);
+    std::ostringstream all;
+    all << in.rdbuf();
+    std::string text = all.str();
+    const std::string reset = "\033[0m";
+    for(size_t at = text.find(reset); at != std::string::npos; at = text.find(reset, at)) {
+        text.erase(at, reset.size());
+    }
+    return text;
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+#if defined(WITH_CLUTCHLOG) and CLUTCHLOG_HAVE_UNIX_SYSIOCTL == 1
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format("{msg}\n");
+
+    const std::string path = "t-out-fd.log";
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    log.out_fd(fd);
+    CHECK(log.out_fd() == fd);
+
+    // Written right away by default.
+    CLUTCHLOG(info, "first");
+    CHECK(content(path) == "first\n");
+
+    // Waiting messages are written along with the one triggering the flush.
+    log.flush_policy(clutchlog::flushing::every_n);
+    log.flush_n(3);
+    CLUTCHLOG(info, "second");
+    CLUTCHLOG(info, "third");
+    CHECK(content(path) == "first\n");
+    CLUTCHLOG(info, "fourth");
+    CHECK(content(path) == "first\nsecond\nthird\nfourth\n");
+
+    // Explicit flush.
+    CLUTCHLOG(info, "fifth");
+    CHECK(content(path) == "first\nsecond\nthird\nfourth\n");
+    log.flush();
+    CHECK(content(path) == "first\nsecond\nthird\nfourth\nfifth\n");
+    log.flush_policy(clutchlog::flushing::always);
+
+    // Asynchronous mode keeps the order.
+    log.async(true);
+    std::string expected = content(path);
+    for(size_t i = 0; i < 1000; ++i) {
+        CLUTCHLOG(info, "async #" << i);
+        expected += "async #" + std::to_string(i) + "\n";
+    }
+    log.flush();
+    CHECK(content(path) == expected);
+    log.async(false);
+
+    // Going back to a stream writes what was waiting.
+    log.flush_policy(clutchlog::flushing::manual);
+    CLUTCHLOG(info, "last");
+    std::ostringstream term;
+    log.out(term);
+    CHECK(log.out_fd() == -1);
+    CHECK(content(path) == expected + "last\n");
+    CLUTCHLOG(info, "on the stream");
+    CHECK(term.str().find("on the stream\n") == 0);
+    CHECK(content(path) == expected + "last\n");
+    log.flush_policy(clutchlog::flushing::always);
+
+    close(fd);
+    std::remove(path.c_str());
+    log.out(std::clog);
+#endif
+}
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+struct point { int x, y; };
+
+std::ostream& operator<<(std::ostream& out, const point& p)
+{
+    return out << "(" << p.x << "," << p.y << ")";
+}
+
+//! Written for any stream, and using the stream itself.
+struct vec { int x, y; };
+
+template<class S>
+S& operator<<(S& out, const vec& v)
+{
+    const std::ios_base::fmtflags flags = out.flags();
+    out << std::showpos << "<" << v.x << "," << v.y << ">";
+    out.flags(flags);
+    return out;
+}
+
+std::ostream& bar(std::ostream& out)
+{
+    out.rdbuf()->sputc('|');
+    return out;
+}
+
+int inner()
+{
+    CLUTCHLOG(debug, "inner " << 1);
+    return 2;
+}
+
+void calls()
+{
+    const std::string word = "word";
+    [[maybe_unused]] const point p{3, 4};
+    CLUTCHLOG(info, "int " << 42 << " neg " << -7L << " uint " << 7u << " char " << 'c' << " bool " << true);
+    CLUTCHLOG(warning, "float " << 1.5f << " double " << 3.14159265358979 << " small " << 1e-20 << " long " << 2.5L);
+    CLUTCHLOG(note, "string " << word << " view " << std::string_view("view") << " custom " << p);
+    CLUTCHLOG(debug, "hex " << std::hex << 255 << " width [" << std::setw(5) << 12 << "] " << std::setprecision(2) << 3.14159);
+    CLUTCHLOG(debug, "nested " << inner() << std::endl);
+    CLUTCHLOG(note, "templated " << (vec{1, 2}) << " bar" << bar << " after " << 3);
+    // Messages are built in the caller itself.
+    [[maybe_unused]] const auto [first, second] = std::pair(5, 6);
+    CLUTCHLOG(info, "bound " << first << second << " in " << __func__);
+    CLUTCHLOG(error, "");
+#ifdef WITH_CLUTCHLOG
+    clutchlog::logger().log(clutchlog::level::info, "without a call site", CLUTCHLOC);
+#endif
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format("{level_fmt}{level_short} {func}:{line} {msg}\n");
+
+    // What the text output looks like.
+    std::ostringstream text;
+    log.out(text);
+    calls();
+
+    // The same messages, recorded.
+    std::ostringstream records;
+    log.out(records);
+    log.out_mode(clutchlog::encoding::records);
+    CHECK(log.out_mode() == clutchlog::encoding::records);
+    calls();
+    CHECK(records.str().find("clutchrecords") == 0);
+    // No formatting at all.
+    CHECK(records.str().find("int 42") == std::string::npos);
+
+    std::ostringstream decoded;
+    log.decode(records.str(), decoded);
+    CHECK(decoded.str() == text.str());
+    CHECK(text.str().find("templated <+1,+2> bar| after 3\n") != std::string::npos);
+    CHECK(text.str().find("bound 56 in calls\n") != std::string::npos);
+
+    // Call sites are defined once.
+    const size_t once = records.str().size();
+    calls();
+    CHECK(records.str().size() - once < once / 2);
+    decoded.str("");
+    log.decode(records.str(), decoded);
+    CHECK(decoded.str().find(text.str()) == 0);
+
+    // Another template.
+    decoded.str("");
+    log.decode(records.str().substr(0, once), decoded, false, "{msg}\n");
+    CHECK(decoded.str().find("int 42 neg -7 uint 7 char c bool 1\n") == 0);
+
+    // Time stamps and threads.
+    decoded.str("");
+    log.decode(records.str().substr(0, once), decoded, true);
+    CHECK(decoded.str().find(" #") != std::string::npos);
+
+    // Sinks are still written as text.
+    std::ostringstream sink;
+    const size_t id = log.add_sink(sink, clutchlog::level::xdebug, "{msg}\n", false);
+    CLUTCHLOG(info, "sunk " << 1.5);
+    log.remove_sink(id);
+    CHECK(sink.str() == "sunk 1.5\n");
+
+    // Records from several threads, in asynchronous mode, on a new output.
+    std::ostringstream async_records;
+    log.out(async_records);
+    log.async(true);
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([](){
+            for(size_t i = 0; i < 100; ++i) {
+                CLUTCHLOG(info, "message #" << i);
+            }
+        });
+    }
+    for(auto& t : threads) { t.join(); }
+    log.async(false);
+    decoded.str("");
+    log.decode(async_records.str(), decoded, false, "{msg}\n");
+    size_t lines = 0;
+    for(char c : decoded.str()) { lines += c == '\n'; }
+    CHECK(lines == 400);
+
+    // Several outputs appended, and bad inputs.
+    decoded.str("");
+    log.decode(records.str() + async_records.str(), decoded, false, "{msg}\n");
+    bool thrown = false;
+    try {
+        log.decode("not records", decoded);
+    } catch(const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    thrown = false;
+    try {
+        log.decode(records.str().substr(0, once - 3), decoded);
+    } catch(const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    log.out_mode(clutchlog::encoding::formatted);
+    log.out(std::clog);
+#endif
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+//! Content of the given generation, compressed or not.
+std::string content(const fs::path& file)
+{
+#if CLUTCHLOG_WITH_ZLIB == 1
+    if(fs::exists(file.string() + ".gz")) {
+        gzFile in = gzopen((file.string() + ".gz").c_str(), "rb");
+        std::string all;
+        char chunk[256];
+        int n;
+        while((n = gzread(in, chunk, sizeof(chunk))) > 0) {
+            all.append(chunk, n);
+        }
+        gzclose(in);
+        return all;
+    }
+#endif
+    std::ifstream in(file);
+    std::ostringstream all;
+    all << in.rdbuf();
+    return all.str();
+}
+
+bool generated(const fs::path& file)
+{
+    return fs::exists(file) or fs::exists(file.string() + ".gz");
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    std::ostringstream term;
+    log.out(term);
+
+    const fs::path dir = "t-rotating_dir";
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    const fs::path path = dir / "run.log";
+
+    {
+        // Rotate above 100 bytes, keep 2 generations.
+        clutchlog::rotating_file file(path.string(), 100, std::chrono::seconds(0), 2);
+        // Unstyled, so that the size of the messages is known.
+        const size_t id = log.add_sink(file, clutchlog::level::xdebug, "{msg}\n", false);
+        for(size_t i = 0; i < 10; ++i) {
+            CLUTCHLOG(info, "message #" << i << " is thirty bytes long");
+        }
+        log.remove_sink(id);
+        file.settle();
+
+        // 10 messages of 32 bytes, 4 per file.
+        CHECK(file.generation() == 2);
+        CHECK(generated(dir / "run.log.1"));
+        CHECK(generated(dir / "run.log.2"));
+#if CLUTCHLOG_WITH_ZLIB == 1
+        CHECK(not fs::exists(dir / "run.log.1"));
+        CHECK(fs::exists(dir / "run.log.1.gz"));
+#endif
+        // Messages are never split across files.
+        CHECK(content(dir / "run.log.1").find("message #0") == 0);
+        CHECK(content(dir / "run.log.2").find("message #4") == 0);
+        CHECK(content(path).find("message #8") == 0);
+        CHECK(content(path).find("message #9") != std::string::npos);
+
+        // Only the last generations are kept.
+        file.rotate();
+        file.rotate();
+        file.settle();
+        CHECK(file.generation() == 4);
+        CHECK(not generated(dir / "run.log.1"));
+        CHECK(not generated(dir / "run.log.2"));
+        CHECK(generated(dir / "run.log.3"));
+        CHECK(generated(dir / "run.log.4"));
+    }
+
+    {
+        // Numbering goes on, and the file rotates when it gets too old.
+        clutchlog::rotating_file file(path.string(), 0, std::chrono::seconds(1), 2);
+        CHECK(file.generation() == 4);
+        const size_t id = log.add_sink(file, clutchlog::level::xdebug, "{msg}\n", false);
+        CLUTCHLOG(info, "before");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        CLUTCHLOG(info, "after");
+        log.remove_sink(id);
+        file.settle();
+        CHECK(file.generation() == 5);
+        CHECK(content(dir / "run.log.5") == "before\n");
+        CHECK(content(path) == "after\n");
+    }
+
+    {
+        // Every old generation is pruned, even if left by another run.
+        std::ofstream(dir / "run.log.1") << "stale";
+        clutchlog::rotating_file file(path.string(), 0, std::chrono::seconds(0), 1);
+        file.rotate();
+        file.settle();
+        CHECK(file.generation() == 6);
+        CHECK(not generated(dir / "run.log.1"));
+        CHECK(not generated(dir / "run.log.4"));
+        CHECK(not generated(dir / "run.log.5"));
+        CHECK(generated(dir / "run.log.6"));
+    }
+
+    {
+        // If the file cannot be renamed, the next rotation waits for the file to grow again.
+        fs::remove(path);
+        fs::create_directory(dir / "run.log.7");
+        std::ofstream(dir / "run.log.7" / "blocker") << "";
+        clutchlog::rotating_file file(path.string(), 100, std::chrono::seconds(0), 2);
+        const size_t id = log.add_sink(file, clutchlog::level::xdebug, "{msg}\n", false);
+        for(size_t i = 0; i < 5; ++i) { // The fifth message tries to rotate.
+            CLUTCHLOG(info, "message #" << i << " is thirty bytes long");
+        }
+        fs::remove_all(dir / "run.log.7");
+        for(size_t i = 5; i < 8; ++i) { // Not 100 more bytes yet.
+            CLUTCHLOG(info, "message #" << i << " is thirty bytes long");
+        }
+        CHECK(file.generation() == 6);
+        CLUTCHLOG(info, "message #8 is thirty bytes long");
+        log.remove_sink(id);
+        file.settle();
+        CHECK(file.generation() == 7);
+        CHECK(content(dir / "run.log.7").find("message #7") != std::string::npos);
+        CHECK(content(path).find("message #8") == 0);
+    }
+
+    log.out(std::clog);
+    fs::remove_all(dir);
+#endif
+}
@@ -0,0 +1,149 @@
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+size_t built = 0;
+
+std::string counted(const std::string& msg)
+{
+    built++;
+    return msg;
+}
+
+//! A buffer noting any write made once it is closed.
+class guarded_buf : public std::stringbuf {
+    public:
+        std::atomic<bool> closed{false};
+        std::atomic<bool> late{false};
+    protected:
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            if(closed.load()) { late.store(true); }
+            return std::stringbuf::xsputn(s, n);
+        }
+        int sync() override
+        {
+            if(closed.load()) { late.store(true); }
+            return std::stringbuf::sync();
+        }
+};
+
+void calls()
+{
+    CLUTCHLOG(progress, counted("progress call"));
+    CLUTCHLOG(xdebug, counted("xdebug call"));
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    auto& log = clutchlog::logger();
+    using level = clutchlog::level;
+    using fmt = clutchlog::fmt;
+
+    std::ostringstream term;
+    log.out(term);
+    log.format(fmt(fmt::fg::red).str() + "{level}: {msg}\n");
+    log.style(level::progress, fmt::fg::green);
+    log.threshold(level::progress);
+
+    // A plain file, at a finer level and with its own format.
+    std::ostringstream file;
+    const size_t id = log.add_sink(file, level::xdebug,
+        fmt(fmt::fg::blue).str() + "{level_short} {level_fmt}{msg}\n", false);
+    CHECK(log.sink_threshold(id) == level::xdebug);
+
+    calls();
+    CHECK(built == 2); // Once for both outputs.
+    CHECK(term.str().find("progress call") != std::string::npos);
+    CHECK(term.str().find("xdebug call") == std::string::npos);
+    CHECK(term.str().find("\033[") != std::string::npos);
+    CHECK(file.str() == "Prog progress call\nXDbg xdebug call\n");
+
+    // The same format and styles share the same row.
+    std::ostringstream twin;
+    const size_t twin_id = log.add_sink(twin, level::progress, log.format());
+    calls();
+    CHECK(twin.str() == term.str().substr(term.str().size() - twin.str().size()));
+
+    // Nothing is built if no output accepts the level.
+    log.sink_threshold(id, level::progress);
+    term.str(""); file.str(""); built = 0;
+    calls();
+    CHECK(built == 1);
+    CHECK(file.str() == "Prog progress call\n");
+
+    // Removed sinks are not written anymore.
+    log.remove_sink(id);
+    log.remove_sink(twin_id);
+    file.str(""); twin.str("");
+    log.threshold(level::xdebug);
+    calls();
+    CHECK(file.str().empty());
+    CHECK(twin.str().empty());
+    CHECK(term.str().find("xdebug call") != std::string::npos);
+
+    // Forced call sites are written everywhere.
+    std::ostringstream quiet;
+    log.threshold(level::critical);
+    log.add_sink(quiet, level::critical, "{msg}\n", false);
+    log.switch_sites(clutchlog::enabled, [](const clutchlog::site_t& site) {
+        return site.stage == level::xdebug;
+    });
+    term.str("");
+    calls();
+    CHECK(quiet.str() == "xdebug call\n");
+    CHECK(term.str().find("xdebug call") != std::string::npos);
+    CHECK(term.str().find("progress call") == std::string::npos);
+
+    // Asynchronous mode writes on the sinks, too.
+    log.async(true);
+    quiet.str("");
+    calls();
+    log.flush();
+    CHECK(quiet.str() == "xdebug call\n");
+
+    // Nothing is written on a sink once it is removed, even by the writer thread.
+    log.threshold(level::info);
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> loggers;
+    for(size_t t = 0; t < 4; ++t) {
+        loggers.emplace_back([&stop](){
+            while(not stop.load()) {
+                CLUTCHLOG(info, "racing");
+            }
+        });
+    }
+    for(size_t n = 0; n < 50; ++n) {
+        guarded_buf buf;
+        std::ostream racing(&buf);
+        const size_t racing_id = log.add_sink(racing, level::info, "{msg}\n", false);
+        std::this_thread::yield();
+        log.remove_sink(racing_id);
+        buf.closed.store(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        CHECK(not buf.late.load());
+    }
+    stop.store(true);
+    for(auto& t : loggers) { t.join(); }
+    log.async(false);
+
+    bool thrown = false;
+    try {
+        log.remove_sink(1000);
+    } catch(const std::out_of_range&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    log.out(std::clog);
+#endif
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+void calls()
+{
+    CLUTCHLOG(debug, "debug call");
+    CLUTCHLOG(info, "info call");
+}
+
+std::string logged()
+{
+    std::ostringstream out;
+    clutchlog::logger().out(out);
+    calls();
+    clutchlog::logger().out(std::clog);
+    return out.str();
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    auto& log = clutchlog::logger();
+    using level = clutchlog::level;
+    log.format("{msg}\n");
+
+    log.threshold(level::warning);
+    CHECK(logged().empty());
+
+    // The call sites have been registered, even if they did not log anything.
+    const auto debug_call = [](const clutchlog::site_t& site) {
+        return std::string(site.func) == "calls" and site.stage == level::debug;
+    };
+    size_t found = 0;
+    for(const clutchlog::site_t* site : log.sites()) {
+        found += debug_call(*site);
+    }
+    CHECK(found == 1);
+
+    // Forced on, whatever the threshold and the location filters.
+    CHECK(log.switch_sites(clutchlog::enabled, debug_call) == 1);
+    log.func("nowhere");
+    CHECK(logged().find("debug call") != std::string::npos);
+    CHECK(logged().find("info call") == std::string::npos);
+    log.func(".*");
+
+    // Forced off, whatever the threshold.
+    log.threshold(level::xdebug);
+    log.switch_sites(clutchlog::disabled, debug_call);
+    CHECK(logged().find("debug call") == std::string::npos);
+    CHECK(logged().find("info call") != std::string::npos);
+
+    // Back to the filters.
+    log.switch_sites(clutchlog::follow, debug_call);
+    CHECK(logged().find("debug call") != std::string::npos);
+#endif
+}
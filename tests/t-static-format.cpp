@@ -0,0 +1,78 @@
+#include <iostream>
+#include <sstream>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+// Templates parsed at compile time need static storage.
+static constexpr char styled[] = "[{name}] {level_fmt}{level_letter}{level_short}:{depth_marks} {msg} {hfill} {funchash_fmt}{func} @ {filehash_fmt}{file}:{line} {{unknown}}\n";
+static constexpr char plain[] = "{level} {msg}\n";
+static constexpr char dump[] = "# {level} in {func} (at depth {depth})";
+
+//! Log the same messages with the given template, at run time or at compile time.
+template<const char* form>
+std::string logged(const bool compiled)
+{
+    auto& log = clutchlog::logger();
+    std::ostringstream out;
+    log.out(out);
+    if(compiled) {
+        log.format<form>();
+    } else {
+        log.format(form);
+    }
+    CLUTCHLOG(info, "hello");
+    CLUTCHLOG(warning, "world " << 42);
+    log.out(std::clog);
+    return out.str();
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.depth_mark("> ");
+
+    // The compile-time engine gives the same results than the run time one.
+#ifdef WITH_CLUTCHLOG // The parsed template only exists in the actual implementation.
+    static_assert(clutchlog::format_t::compiled<plain>::size == 4);
+    static_assert(clutchlog::format_t::compiled<plain>::tokens[0].type == clutchlog::format_t::tag::level);
+#endif
+    const std::string s_run = logged<styled>(false);
+    const std::string s_com = logged<styled>(true);
+    std::clog << s_com;
+    CHECK(s_run == s_com);
+    CHECK(logged<plain>(false) == logged<plain>(true));
+#ifdef WITH_CLUTCHLOG
+    CHECK(log.format() == plain);
+#endif
+
+    // Setting a run time template falls back to the run time engine.
+    std::ostringstream out;
+    log.out(out);
+    log.format("{msg}\n");
+    CLUTCHLOG(info, "runtime");
+    log.out(std::clog);
+#ifdef WITH_CLUTCHLOG
+    CHECK(out.str().find("runtime\n") != std::string::npos);
+    CHECK(out.str().find("Info") == std::string::npos);
+#endif
+
+    // Dump comments too.
+    log.format_comment<dump>();
+#ifdef WITH_CLUTCHLOG
+    CHECK(log.format_comment() == dump);
+#endif
+    std::vector<int> v = {1,2,3};
+    CLUTCHDUMP(info, v, "t-static-format.dat");
+    std::ifstream in("t-static-format.dat");
+    std::string line;
+    std::getline(in, line);
+#ifdef WITH_CLUTCHLOG
+    CHECK(line.find("# Info in main (at depth") != std::string::npos);
+#endif
+    in.close();
+    std::remove("t-static-format.dat");
+}
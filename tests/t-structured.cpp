@@ -0,0 +1,68 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+void calls()
+{
+    CLUTCHLOG(warning, "say \"hi\"\tto C:\\ and\nbeyond \x01 é");
+    CLUTCHLOG(info, "plain");
+}
+
+int main(/*const int argc, char* argv[]*/)
+{
+#ifdef WITH_CLUTCHLOG
+    auto& log = clutchlog::logger();
+    log.threshold(clutchlog::level::xdebug);
+    log.format("{level_fmt}{msg} {hfill} {func}\n");
+    log.filename(clutchlog::filename::base);
+
+    std::ostringstream out;
+    log.out(out);
+
+    // JSON Lines.
+    log.out_mode(clutchlog::encoding::json);
+    calls();
+    const std::string json = out.str();
+    const std::string first = json.substr(0, json.find('\n') + 1);
+    // One object per line, without any style nor filling.
+    CHECK(json.find("\033[") == std::string::npos);
+    CHECK(first.front() == '{');
+    CHECK(first.substr(first.size() - 2) == "}\n");
+    CHECK(first.find("{\"timestamp\":\"") == 0);
+    CHECK(first[14+4] == '-' and first[14+10] == 'T' and first[14+26] == 'Z');
+    CHECK(first.find(",\"level\":\"Warning\",") != std::string::npos);
+    CHECK(first.find(",\"file\":\"t-structured.cpp\",\"func\":\"calls\",\"line\":12,") != std::string::npos);
+    CHECK(first.find(",\"message\":\"say \\\"hi\\\"\\tto C:\\\\ and\\nbeyond \\u0001 é\"}") != std::string::npos);
+#if CLUTCHLOG_HAVE_UNIX_SYSINFO == 1
+    CHECK(first.find(",\"name\":\"t-structured\",") != std::string::npos);
+    CHECK(first.find(",\"depth\":") != std::string::npos);
+#endif
+
+    // logfmt.
+    out.str("");
+    log.out_mode(clutchlog::encoding::logfmt);
+    calls();
+    const std::string logfmt = out.str();
+    CHECK(logfmt.find("\033[") == std::string::npos);
+    CHECK(logfmt.find("timestamp=") == 0);
+    CHECK(logfmt.find(" level=Warning ") != std::string::npos);
+    CHECK(logfmt.find(" file=t-structured.cpp func=calls line=12 ") != std::string::npos);
+    CHECK(logfmt.find(" message=\"say \\\"hi\\\"\\tto C:\\\\ and\\nbeyond \\u0001 é\"\n") != std::string::npos);
+    CHECK(logfmt.find(" level=Info ") != std::string::npos);
+    CHECK(logfmt.find(" message=plain\n") != std::string::npos);
+
+    // Sinks are still formatted.
+    std::ostringstream sink;
+    log.add_sink(sink, clutchlog::level::xdebug, "{msg}\n", false);
+    CLUTCHLOG(info, "sunk");
+    CHECK(sink.str() == "sunk\n");
+
+    log.out_mode(clutchlog::encoding::formatted);
+    log.out(std::clog);
+#endif
+}
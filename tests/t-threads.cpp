@@ -0,0 +1,79 @@
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <set>
+#include <atomic>
+
+// Keep info messages in Release builds.
+#define CLUTCHLOG_DEFAULT_DEPTH_BUILT_NODEBUG clutchlog::level::xdebug
+#include "../clutchlog/clutchlog.h"
+#include "check.h"
+
+int main(/*const int argc, char* argv[]*/)
+{
+    auto& log = clutchlog::logger();
+    log.format("{msg}\n");
+    log.threshold(clutchlog::level::xdebug);
+    log.style(clutchlog::level::info, clutchlog::fmt());
+
+    const size_t nb_threads = 8;
+    const size_t n = 2000;
+
+    std::ostringstream out;
+    log.out(out);
+
+    // Change the configuration while the workers are logging.
+    std::atomic<bool> done(false);
+    std::thread configurer([&log,&done](){
+        size_t i = 0;
+        while(not done.load()) {
+            if(i % 2 == 0) {
+                log.threshold(clutchlog::level::debug);
+                log.location(".*", "(main|operator)");
+            } else {
+                log.threshold(clutchlog::level::xdebug);
+                log.location("t-threads");
+            }
+            i++;
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for(size_t t = 0; t < nb_threads; ++t) {
+        workers.emplace_back([t,n](){
+            for(size_t i = 0; i < n; ++i) {
+                CLUTCHLOG(info, "<" << t << ":" << i << ">");
+            }
+        });
+    }
+    for(auto& w : workers) { w.join(); }
+    done.store(true);
+    configurer.join();
+
+    log.out(std::clog);
+    log.threshold(clutchlog::level::xdebug);
+    log.location(".*");
+
+    // Every line is whole, and appears once.
+    std::string all = out.str();
+    const std::string reset = clutchlog::fmt(clutchlog::fmt::typo::reset).str();
+    if(not reset.empty()) {
+        for(size_t at = all.find(reset); at != std::string::npos; at = all.find(reset, at)) {
+            all.erase(at, reset.size());
+        }
+    }
+    std::istringstream lines(all);
+    std::set<std::string> seen;
+    for(std::string line; std::getline(lines, line);) {
+        CHECK(line.size() > 4 and line.front() == '<' and line.back() == '>');
+        CHECK(line.find('<', 1) == std::string::npos);
+        CHECK(seen.insert(line).second);
+    }
+#ifdef WITH_CLUTCHLOG
+    CHECK(seen.size() == nb_threads * n);
+#endif
+
+    CLUTCHLOG(info, "threads: " << seen.size() << " whole lines");
+}
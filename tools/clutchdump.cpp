@@ -0,0 +1,70 @@
+/** Convert binary dumps (see `clutchlog::dumping::binary`) to text.
+ *
+ * Usage: clutchdump <file.dat> [separator]
+ *
+ * The text is written on the standard output,
+ * as it would have been dumped in text mode.
+ */
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The tool needs the actual implementation, whatever the build type.
+#ifndef WITH_CLUTCHLOG
+    #define WITH_CLUTCHLOG
+#endif
+#include "../clutchlog/clutchlog.h"
+
+int main(const int argc, char* argv[])
+{
+    if(argc < 2 or argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <file.dat> [separator]" << std::endl;
+        return 1;
+    }
+    const std::string sep = argc == 3 ? argv[2] : CLUTCHDUMP_DEFAULT_SEP;
+
+    const int fd = open(argv[1], O_RDONLY);
+    if(fd < 0) {
+        std::cerr << argv[1] << ": " << std::strerror(errno) << std::endl;
+        return 2;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        std::cerr << argv[1] << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return 2;
+    }
+    const size_t size = st.st_size;
+
+    // Map the whole file, so that the items are read in place.
+    void* data = nullptr;
+    if(size > 0) {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED) {
+            std::cerr << argv[1] << ": " << std::strerror(errno) << std::endl;
+            close(fd);
+            return 2;
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    int status = 0;
+    try {
+        clutchlog::undump(std::string_view(static_cast<const char*>(data), size), std::cout, sep);
+    } catch(const std::invalid_argument& err) {
+        std::cerr << argv[1] << ": " << err.what() << std::endl;
+        status = 3;
+    }
+
+    if(size > 0) {
+        munmap(data, size);
+    }
+    return status;
+}
@@ -0,0 +1,80 @@
+/** Convert binary records (see `clutchlog::encoding::records`) to formatted messages.
+ *
+ * Usage: clutchlog-decode [-t] <file.log> [format]
+ *
+ * The messages are written on the standard output,
+ * with the template of their call site (or the given one),
+ * and the default level names and styles.
+ * With `-t`, each message is preceded by its time stamp and thread number.
+ */
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The tool needs the actual implementation, whatever the build type.
+#ifndef WITH_CLUTCHLOG
+    #define WITH_CLUTCHLOG
+#endif
+#include "../clutchlog/clutchlog.h"
+
+int main(const int argc, char* argv[])
+{
+    int arg = 1;
+    const bool stamps = argc > 1 and std::string(argv[1]) == "-t";
+    if(stamps) {
+        arg++;
+    }
+    if(argc - arg < 1 or argc - arg > 2) {
+        std::cerr << "Usage: " << argv[0] << " [-t] <file.log> [format]" << std::endl;
+        return 1;
+    }
+    const char* path = argv[arg];
+    const std::string form = argc - arg == 2 ? argv[arg+1] : "";
+
+    const int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        std::cerr << path << ": " << std::strerror(errno) << std::endl;
+        return 2;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        std::cerr << path << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return 2;
+    }
+    const size_t size = st.st_size;
+
+    // Map the whole file, so that the records are read in place.
+    void* data = nullptr;
+    if(size > 0) {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED) {
+            std::cerr << path << ": " << std::strerror(errno) << std::endl;
+            close(fd);
+            return 2;
+        }
+    }
+    close(fd);
+
+    int status = 0;
+    try {
+        auto& log = clutchlog::logger();
+        log.out(std::cout);
+        log.decode(std::string_view(static_cast<const char*>(data), size), std::cout, stamps, form);
+    } catch(const std::invalid_argument& err) {
+        std::cout.flush();
+        std::cerr << path << ": " << err.what() << std::endl;
+        status = 3;
+    }
+
+    if(size > 0) {
+        munmap(data, size);
+    }
+    return status;
+}